@@ -3,27 +3,62 @@
 
 #define configUSE_PREEMPTION                    1
 #define configUSE_IDLE_HOOK                     0
-#define configUSE_TICK_HOOK                     0
+#define configUSE_TICK_HOOK                     1   // sim_time.c: run limit and exit requests while busy
 #define configCPU_CLOCK_HZ                      ( ( unsigned long ) 100000000 )
 #define configTICK_RATE_HZ                      ( ( TickType_t ) 1000 )
 #define configMAX_PRIORITIES                    ( 7 )
 #define configMINIMAL_STACK_SIZE                ( 512 )
-#define configTOTAL_HEAP_SIZE                   ( ( size_t ) ( 32 * 1024 ) )
+#define configTOTAL_HEAP_SIZE                   ( ( size_t ) ( 48 * 1024 ) )  // >= SIM_HEAP_BUDGET (task_scheduler.h)
 #define configMAX_TASK_NAME_LEN                 ( 16 )
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_16_BIT_TICKS                  0
 #define configIDLE_SHOULD_YIELD                 1
 #define configUSE_MUTEXES                       1
-#define configQUEUE_REGISTRY_SIZE               8
+#define configQUEUE_REGISTRY_SIZE               8   // Filled by queue_stats_register()
 #define configCHECK_FOR_STACK_OVERFLOW          2   // Enable advanced stack overflow checking
 #define configUSE_MALLOC_FAILED_HOOK            1
 #define configUSE_APPLICATION_TASK_TAG          0
 #define configUSE_COUNTING_SEMAPHORES           1
 #define configGENERATE_RUN_TIME_STATS           1   // Enable runtime stats
 #define configUSE_STATS_FORMATTING_FUNCTIONS    1
+#define configUSE_TICKLESS_IDLE                 1   // Idle hook into sim_time: virtual time, host sleep
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+#define INCLUDE_vTaskDelayUntil                 1
+#define INCLUDE_xTaskGetCurrentTaskHandle       1   // Used by the queue trace hooks
 
-// Hook function prototypes
-extern void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName);
+// Static allocation build (make STATIC=1): all kernel objects use reserved storage
+#ifdef SIM_STATIC_ALLOCATION
+#define configSUPPORT_STATIC_ALLOCATION         1
+#define configSUPPORT_DYNAMIC_ALLOCATION        0
+#else
+#define configSUPPORT_STATIC_ALLOCATION         0
+#define configSUPPORT_DYNAMIC_ALLOCATION        1
+#endif
+
+// Virtual time / host sleep: the idle task hands expected idle periods to sim_time.c
+extern void sim_time_suppress_ticks_and_sleep(uint32_t xExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP(xExpectedIdleTime) sim_time_suppress_ticks_and_sleep(xExpectedIdleTime)
+
+// Queue telemetry: the trace hooks expand inside queue.c, where Queue_t is visible
+extern void queue_stats_trace_send(unsigned long uxQueueNumber, unsigned long uxMessagesWaiting);
+extern void queue_stats_trace_send_from_isr(unsigned long uxQueueNumber, unsigned long uxMessagesWaiting);
+extern void queue_stats_trace_send_failed(unsigned long uxQueueNumber, int xFromISR);
+extern void queue_stats_trace_receive(unsigned long uxQueueNumber, int xFromISR);
+extern void queue_stats_trace_receive_failed(unsigned long uxQueueNumber, int xFromISR);
+extern void queue_stats_trace_blocking(unsigned long uxQueueNumber, int xOnSend);
+#define traceQUEUE_SEND(pxQueue)                    queue_stats_trace_send((pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting + 1)
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           queue_stats_trace_send_from_isr((pxQueue)->uxQueueNumber, (pxQueue)->uxMessagesWaiting + 1)
+#define traceQUEUE_SEND_FAILED(pxQueue)             queue_stats_trace_send_failed((pxQueue)->uxQueueNumber, 0)
+#define traceQUEUE_SEND_FROM_ISR_FAILED(pxQueue)    queue_stats_trace_send_failed((pxQueue)->uxQueueNumber, 1)
+#define traceQUEUE_RECEIVE(pxQueue)                 queue_stats_trace_receive((pxQueue)->uxQueueNumber, 0)
+#define traceQUEUE_RECEIVE_FROM_ISR(pxQueue)        queue_stats_trace_receive((pxQueue)->uxQueueNumber, 1)
+#define traceQUEUE_RECEIVE_FAILED(pxQueue)          queue_stats_trace_receive_failed((pxQueue)->uxQueueNumber, 0)
+#define traceQUEUE_RECEIVE_FROM_ISR_FAILED(pxQueue) queue_stats_trace_receive_failed((pxQueue)->uxQueueNumber, 1)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue)        queue_stats_trace_blocking((pxQueue)->uxQueueNumber, 1)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue)     queue_stats_trace_blocking((pxQueue)->uxQueueNumber, 0)
+
+// Hook function prototypes (vApplicationStackOverflowHook is declared by task.h;
+// TaskHandle_t is not yet defined when this file is included)
 extern void vApplicationMallocFailedHook(void);
 
 #endif // FREERTOS_CONFIG_H
\ No newline at end of file
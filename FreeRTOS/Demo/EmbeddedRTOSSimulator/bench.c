@@ -0,0 +1,621 @@
+// EmbeddedRTOSSimulator - bench.c
+// Microbenchmarks for the device models and inter-task queues.
+// Built by `make bench` with -DSIM_QUIET so the models do not print.
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "board.h"
+#include "uart.h"
+#include "spi.h"
+#include "pci.h"
+#include "task_scheduler.h"
+#include "lru_cache.h"
+#include "sim_alloc.h"
+#include "crc32c.h"
+#include "frame.h"
+#include "sensor_codec.h"
+#include "replay.h"
+#ifdef SIM_HEAP_POOL
+#include "heap_pool.h"
+#endif
+
+#define BENCH_REPEATS         5
+#define BENCH_DEFAULT_ITERS   200000
+#define BENCH_MAX_RESULTS     32
+#define BENCH_NAME_LEN        48
+#define BENCH_DEFAULT_THRESHOLD 10.0
+
+struct bench_case {
+    const char *name;
+    void (*run)(uint32_t iters);
+    uint32_t iters;
+};
+
+struct bench_result {
+    char name[BENCH_NAME_LEN];
+    uint32_t iters;
+    double ns_per_op;   // best of BENCH_REPEATS
+    double ns_median;
+};
+
+static struct bench_result results[BENCH_MAX_RESULTS];
+static size_t num_results = 0;
+
+static const char *json_path = "bench_results.json";
+static const char *baseline_path = NULL;
+static double threshold_pct = BENCH_DEFAULT_THRESHOLD;
+static double iter_scale = 1.0;
+static const char *name_filter = NULL;
+static const char *trace_path = "replay_example.trace";
+
+// Sink so the compiler cannot drop the work being measured
+static volatile uint32_t bench_sink;
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// --- Benchmark cases ---
+
+static void bench_lru_put(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; ++i) {
+        lru_cache_put((int)(i % (LRU_CACHE_SIZE * 2)), (int)i);
+    }
+}
+
+static void bench_lru_get(uint32_t iters) {
+    int found;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        acc += (uint32_t)lru_cache_get((int)(i % (LRU_CACHE_SIZE * 2)), &found);
+    }
+    bench_sink = acc;
+}
+
+static void bench_pci_axi_write(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; ++i) {
+        // Spread across all outbound ATU regions
+        pci_axi_write(0x80000000 + (i % PCI_NUM_ATU_REGIONS) * 0x100000 + (i & 0xFFC), i);
+    }
+    bench_sink = g_pci.axi_addr;
+}
+
+static void bench_pci_axi_read(uint32_t iters) {
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        acc += pci_axi_read(0x80000000 + (i % PCI_NUM_ATU_REGIONS) * 0x100000 + (i & 0xFFC));
+    }
+    bench_sink = acc;
+}
+
+static void bench_board_reg_write(uint32_t iters) {
+    static const uint32_t regs[] = { BOARD_REG_UART, BOARD_REG_SPI, BOARD_REG_PCI, BOARD_REG_SENSOR };
+    for (uint32_t i = 0; i < iters; ++i) {
+        board_reg_write(regs[i & 3], i);
+    }
+}
+
+static void bench_board_reg_read(uint32_t iters) {
+    static const uint32_t regs[] = { BOARD_REG_UART, BOARD_REG_SPI, BOARD_REG_PCI, BOARD_REG_SENSOR };
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        acc += board_reg_read(regs[i & 3]);
+    }
+    bench_sink = acc;
+}
+
+static void bench_uart_send(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; ++i) {
+        uart_send("Sensor value: 123 at 45678");
+    }
+    bench_sink = g_uart.tx_bytes;
+}
+
+static void bench_uart_receive(uint32_t iters) {
+    char buf[32];
+    for (uint32_t i = 0; i < iters; ++i) {
+        g_uart.rx_head = g_uart.rx_tail = 0;
+        uart_simulate_rx_event("0123456789");
+        uart_receive(buf, sizeof(buf));
+    }
+    bench_sink = (uint32_t)buf[0];
+}
+
+static void bench_spi_transfer(uint32_t iters) {
+    static const char tx[] = "Sensor value: 123 at 45678";
+    char rx[32];
+    for (uint32_t i = 0; i < iters; ++i) {
+        // Text transfers echo into the RX ring and queue, which nothing reads here
+        g_spi.rx_head = g_spi.rx_tail = 0;
+        xQueueReset(g_spi.rx_queue);
+        spi_transfer(tx, rx, sizeof(tx));
+    }
+    bench_sink = (uint32_t)rx[0];
+}
+
+static void bench_uart_write_frame(uint32_t iters) {
+    static const sensor_msg_t msg = { .sensor_value = 123, .timestamp = 45678 };
+    uint8_t frame[FRAME_MAX_SIZE];
+    size_t n = frame_encode_sensor(frame, sizeof(frame), 0, &msg);
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        acc += (uint32_t)uart_write(frame, n);
+    }
+    bench_sink = acc;
+}
+
+static void bench_spi_transfer_frame(uint32_t iters) {
+    static const sensor_msg_t msg = { .sensor_value = 123, .timestamp = 45678 };
+    uint8_t frame[FRAME_MAX_SIZE], rx[FRAME_MAX_SIZE];
+    size_t n = frame_encode_sensor(frame, sizeof(frame), 0, &msg);
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        acc += (uint32_t)spi_transfer_bytes(frame, rx, n);
+    }
+    bench_sink = acc + rx[0];
+}
+
+// --- Link protocol: CRC backends, framing vs the text messages it replaced ---
+
+#define CRC_BENCH_LEN 256
+static uint8_t crc_bench_buf[CRC_BENCH_LEN];
+
+static void bench_crc32c(uint32_t iters) {
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        crc = crc32c(crc, crc_bench_buf, sizeof(crc_bench_buf));
+    }
+    bench_sink = crc;
+}
+
+static void bench_crc32c_sw(uint32_t iters) {
+    uint32_t crc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        crc = crc32c_sw(crc, crc_bench_buf, sizeof(crc_bench_buf));
+    }
+    bench_sink = crc;
+}
+
+static void bench_frame_encode_sensor(uint32_t iters) {
+    uint8_t frame[FRAME_MAX_SIZE];
+    sensor_msg_t msg = { .sensor_value = 0, .timestamp = 45678 };
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        msg.sensor_value = (int)(i % 1000);
+        acc += (uint32_t)frame_encode_sensor(frame, sizeof(frame), (uint16_t)i, &msg);
+    }
+    bench_sink = acc + frame[FRAME_SENSOR_PAYLOAD + FRAME_HEADER_SIZE];
+}
+
+static void bench_frame_parse_sensor(uint32_t iters) {
+    static struct frame_parser parser;
+    static const sensor_msg_t msg = { .sensor_value = 123, .timestamp = 45678 };
+    uint8_t frame[FRAME_MAX_SIZE];
+    size_t n = frame_encode_sensor(frame, sizeof(frame), 0, &msg);
+    uint32_t acc = 0;
+    frame_parser_init(&parser);
+    for (uint32_t i = 0; i < iters; ++i) {
+        const uint8_t *p = frame;
+        size_t left = n;
+        struct frame f;
+        sensor_msg_t out;
+        if (frame_parse(&parser, &p, &left, &f) && frame_decode_sensor(&f, &out) == 0) {
+            acc += (uint32_t)out.sensor_value;
+        }
+    }
+    bench_sink = acc;
+}
+
+// The formatting/parsing the frames replaced, for comparison
+static void bench_text_format_parse(uint32_t iters) {
+    char text[64];
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        int value;
+        unsigned ts;
+        snprintf(text, sizeof(text), "Sensor value: %d at %u", (int)(i % 1000), 45678u);
+        if (sscanf(text, "Sensor value: %d at %u", &value, &ts) == 2) acc += (uint32_t)value;
+    }
+    bench_sink = acc;
+}
+
+// --- Sensor codec: one op is one sample, over a fixed sample set ---
+
+#define CODEC_SAMPLES   4096
+#define CODEC_OUT_SIZE  (CODEC_SAMPLES * SENSOR_CODEC_MAX_SAMPLE_BYTES)
+
+static sensor_msg_t codec_synthetic[CODEC_SAMPLES];
+static sensor_msg_t codec_replay[CODEC_SAMPLES];
+static uint8_t codec_out[CODEC_OUT_SIZE];
+static uint8_t codec_encoded[CODEC_OUT_SIZE];
+static size_t codec_encoded_len;
+
+// Slow drift with noise and flat stretches, sampled every 10 ticks with some jitter
+static void codec_make_synthetic(void) {
+    uint32_t rng = 12345;
+    int value = 512;
+    uint32_t ts = 0;
+    for (int i = 0; i < CODEC_SAMPLES; ++i) {
+        rng = rng * 1103515245u + 12345u;
+        if ((i / 64) % 4 != 3) value += (int)((rng >> 16) % 7) - 3;
+        ts += ((rng >> 8) % 16 == 0) ? 11 : 10;
+        codec_synthetic[i].sensor_value = value;
+        codec_synthetic[i].timestamp = ts;
+    }
+}
+
+// SENSOR events of a replay trace, looped to fill the set; synthetic data if it has none
+static void codec_load_replay(const char *path) {
+    replay_trace_t trace;
+    replay_event_t ev;
+    uint32_t base = 0, last = 0;
+    size_t n = 0;
+    if (replay_trace_open(&trace, path) == 0) {
+        while (n < CODEC_SAMPLES) {
+            if (!replay_trace_next(&trace, &ev)) {
+                if (n == 0) break;
+                replay_trace_rewind(&trace);
+                base = last + 1;
+                continue;
+            }
+            if (ev.type != REPLAY_EV_SENSOR) continue;
+            last = base + ev.time_ms;
+            codec_replay[n].sensor_value = ev.sensor_value;
+            codec_replay[n].timestamp = last;
+            n++;
+        }
+        replay_trace_close(&trace);
+    }
+    if (n == 0) {
+        printf("[Bench] No SENSOR events in %s, codec_*_replay uses synthetic data\n", path);
+        memcpy(codec_replay, codec_synthetic, sizeof(codec_replay));
+    }
+}
+
+static size_t codec_encode_all(const sensor_msg_t *in, uint32_t reset, int rle, uint8_t *out) {
+    struct sensor_encoder enc;
+    size_t taken, len;
+    sensor_encoder_init(&enc, reset, rle);
+    len = sensor_encode(&enc, in, CODEC_SAMPLES, &taken, out, CODEC_OUT_SIZE);
+    return len + sensor_encoder_flush(&enc, out + len, CODEC_OUT_SIZE - len);
+}
+
+static void bench_codec_report(void) {
+    static const struct { const char *name; const sensor_msg_t *data; } sets[] = {
+        { "synthetic", codec_synthetic },
+        { "replay",    codec_replay },
+    };
+    size_t raw = CODEC_SAMPLES * sizeof(sensor_msg_t);
+    for (size_t i = 0; i < sizeof(sets) / sizeof(sets[0]); ++i) {
+        size_t plain = codec_encode_all(sets[i].data, SENSOR_CODEC_DEFAULT_RESET, 0, codec_out);
+        size_t rle = codec_encode_all(sets[i].data, SENSOR_CODEC_DEFAULT_RESET, 1, codec_out);
+        printf("[Bench] sensor_codec %-9s %u samples: %u B raw, %u B delta/varint (%.2fx), %u B with RLE (%.2fx)\n",
+               sets[i].name, CODEC_SAMPLES, (unsigned)raw, (unsigned)plain, (double)raw / plain,
+               (unsigned)rle, (double)raw / rle);
+    }
+}
+
+static void codec_bench_encode(const sensor_msg_t *in, int rle, uint32_t iters) {
+    static struct sensor_encoder enc;
+    size_t pos = 0, taken;
+    sensor_encoder_init(&enc, SENSOR_CODEC_DEFAULT_RESET, rle);
+    for (uint32_t i = 0; i < iters; ++i) {
+        if (CODEC_OUT_SIZE - pos < SENSOR_CODEC_MAX_SAMPLE_BYTES) pos = 0;
+        pos += sensor_encode(&enc, &in[i % CODEC_SAMPLES], 1, &taken, codec_out + pos, CODEC_OUT_SIZE - pos);
+    }
+    bench_sink = (uint32_t)pos;
+}
+
+static void bench_codec_encode_synthetic(uint32_t iters) {
+    codec_bench_encode(codec_synthetic, 0, iters);
+}
+
+static void bench_codec_encode_synthetic_rle(uint32_t iters) {
+    codec_bench_encode(codec_synthetic, 1, iters);
+}
+
+static void bench_codec_encode_replay(uint32_t iters) {
+    codec_bench_encode(codec_replay, 0, iters);
+}
+
+static void bench_codec_decode_synthetic(uint32_t iters) {
+    static struct sensor_decoder dec;
+    size_t pos = 0, used;
+    sensor_msg_t out = { 0 };
+    sensor_decoder_init(&dec);
+    for (uint32_t i = 0; i < iters; ++i) {
+        if (pos >= codec_encoded_len) {
+            sensor_decoder_init(&dec);
+            pos = 0;
+        }
+        sensor_decode(&dec, codec_encoded + pos, codec_encoded_len - pos, &used, &out, 1);
+        pos += used;
+    }
+    bench_sink = (uint32_t)out.sensor_value;
+}
+
+static void bench_sensor_queue_roundtrip(uint32_t iters) {
+    sensor_msg_t msg = { .sensor_value = 0, .timestamp = 0 };
+    sensor_msg_t out;
+    uint32_t acc = 0;
+    for (uint32_t i = 0; i < iters; ++i) {
+        msg.sensor_value = (int)i;
+        send_sensor_data(&msg, 0);
+        recv_sensor_data(&out, 0);
+        acc += (uint32_t)out.sensor_value;
+    }
+    bench_sink = acc;
+}
+
+#if configSUPPORT_DYNAMIC_ALLOCATION
+// The simulator's start-up allocations (TCB + stack per task, one block per
+// queue, semaphore and event group), allocated in order and then freed.
+static const size_t sim_alloc_pattern[] = {
+    sizeof(StaticTask_t), TASK_STACK_PCIE * sizeof(StackType_t),
+    sizeof(StaticTask_t), TASK_STACK_PCIE * sizeof(StackType_t),
+    sizeof(StaticTask_t), TASK_STACK_SENSOR * sizeof(StackType_t),
+    sizeof(StaticTask_t), TASK_STACK_PROTOCOL * sizeof(StackType_t),
+    sizeof(StaticTask_t), TASK_STACK_LOGGER * sizeof(StackType_t),
+    sizeof(StaticQueue_t) + QUEUE_LEN_SENSOR * sizeof(sensor_msg_t),
+    sizeof(StaticQueue_t) + QUEUE_LEN_LOG * sizeof(protocol_log_t),
+    sizeof(StaticQueue_t),
+    sizeof(StaticEventGroup_t),
+    sizeof(StaticQueue_t) + UART_RX_BUFFER_SIZE,
+    sizeof(StaticQueue_t) + SPI_BUFFER_SIZE,
+    sizeof(StaticQueue_t) + PCI_EVENT_QUEUE_LEN * sizeof(pci_int_type_t),
+};
+#define SIM_PATTERN_LEN (sizeof(sim_alloc_pattern) / sizeof(sim_alloc_pattern[0]))
+
+static void bench_heap_sim_pattern(uint32_t iters) {
+    void *blocks[SIM_PATTERN_LEN];
+    for (uint32_t i = 0; i < iters; ++i) {
+        for (size_t b = 0; b < SIM_PATTERN_LEN; ++b) {
+            blocks[b] = pvPortMalloc(sim_alloc_pattern[b]);
+        }
+        for (size_t b = SIM_PATTERN_LEN; b-- > 0;) {
+            vPortFree(blocks[b]);
+        }
+    }
+}
+
+// Random alloc/free over a small live set; the same seed every run so both
+// heaps see the identical request stream.
+#define CHURN_SLOTS 16
+static void bench_heap_churn(uint32_t iters) {
+    void *slots[CHURN_SLOTS] = { 0 };
+    uint32_t rng = 12345;
+    for (uint32_t i = 0; i < iters; ++i) {
+        rng = rng * 1103515245u + 12345u;
+        uint32_t slot = (rng >> 16) % CHURN_SLOTS;
+        if (slots[slot]) {
+            vPortFree(slots[slot]);
+            slots[slot] = NULL;
+        } else {
+            // Mostly small kernel-object-sized requests, some stack-sized ones
+            size_t size = (rng & 3) ? 16 + (rng >> 8) % 496 : 512 + (rng >> 8) % 1536;
+            slots[slot] = pvPortMalloc(size);
+        }
+    }
+    for (int i = 0; i < CHURN_SLOTS; ++i) {
+        vPortFree(slots[i]);
+    }
+}
+#endif
+
+static const struct bench_case bench_cases[] = {
+    { "lru_cache_put",            bench_lru_put,                BENCH_DEFAULT_ITERS },
+    { "lru_cache_get",            bench_lru_get,                BENCH_DEFAULT_ITERS },
+    { "pci_axi_write",            bench_pci_axi_write,          BENCH_DEFAULT_ITERS },
+    { "pci_axi_read",             bench_pci_axi_read,           BENCH_DEFAULT_ITERS },
+    { "board_reg_write",          bench_board_reg_write,        BENCH_DEFAULT_ITERS },
+    { "board_reg_read",           bench_board_reg_read,         BENCH_DEFAULT_ITERS },
+    { "uart_send",                bench_uart_send,              BENCH_DEFAULT_ITERS / 4 },
+    { "uart_receive",             bench_uart_receive,           BENCH_DEFAULT_ITERS / 20 },
+    { "spi_transfer",             bench_spi_transfer,           BENCH_DEFAULT_ITERS / 20 },
+    { "uart_write_frame",         bench_uart_write_frame,       BENCH_DEFAULT_ITERS / 4 },
+    { "spi_transfer_frame",       bench_spi_transfer_frame,     BENCH_DEFAULT_ITERS / 20 },
+    { "crc32c_256B",              bench_crc32c,                 BENCH_DEFAULT_ITERS },
+    { "crc32c_sw_256B",           bench_crc32c_sw,              BENCH_DEFAULT_ITERS },
+    { "frame_encode_sensor",      bench_frame_encode_sensor,    BENCH_DEFAULT_ITERS },
+    { "frame_parse_sensor",       bench_frame_parse_sensor,     BENCH_DEFAULT_ITERS },
+    { "text_format_parse",        bench_text_format_parse,      BENCH_DEFAULT_ITERS / 4 },
+    { "codec_encode_synthetic",   bench_codec_encode_synthetic, BENCH_DEFAULT_ITERS },
+    { "codec_encode_synthetic_rle", bench_codec_encode_synthetic_rle, BENCH_DEFAULT_ITERS },
+    { "codec_encode_replay",      bench_codec_encode_replay,    BENCH_DEFAULT_ITERS },
+    { "codec_decode_synthetic",   bench_codec_decode_synthetic, BENCH_DEFAULT_ITERS },
+    { "sensor_queue_roundtrip",   bench_sensor_queue_roundtrip, BENCH_DEFAULT_ITERS / 4 },
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    { "heap_sim_pattern",         bench_heap_sim_pattern,       BENCH_DEFAULT_ITERS / 20 },
+    { "heap_churn",               bench_heap_churn,             BENCH_DEFAULT_ITERS },
+#endif
+};
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_run_case(const struct bench_case *bc) {
+    uint32_t iters = (uint32_t)(bc->iters * iter_scale);
+    double samples[BENCH_REPEATS];
+    if (iters == 0) iters = 1;
+    bc->run(iters / 10 + 1); // warm-up
+    for (int r = 0; r < BENCH_REPEATS; ++r) {
+        uint64_t t0 = bench_now_ns();
+        bc->run(iters);
+        uint64_t t1 = bench_now_ns();
+        samples[r] = (double)(t1 - t0) / iters;
+    }
+    qsort(samples, BENCH_REPEATS, sizeof(samples[0]), cmp_double);
+    if (num_results < BENCH_MAX_RESULTS) {
+        struct bench_result *res = &results[num_results++];
+        snprintf(res->name, sizeof(res->name), "%s", bc->name);
+        res->iters = iters;
+        res->ns_per_op = samples[0];
+        res->ns_median = samples[BENCH_REPEATS / 2];
+        printf("[Bench] %-26s %10.1f ns/op (median %.1f, %u iters)\n", res->name, res->ns_per_op, res->ns_median, iters);
+    }
+}
+
+// --- JSON output / baseline comparison ---
+
+// One result object per line so the compare mode can read files back with sscanf.
+static int bench_write_json(const char *path) {
+    FILE *f = fopen(path, "w");
+    if (!f) {
+        printf("[Bench] Cannot write %s\n", path);
+        return -1;
+    }
+    fprintf(f, "{\n  \"version\": 1,\n  \"unit\": \"ns_per_op\",\n  \"results\": [\n");
+    for (size_t i = 0; i < num_results; ++i) {
+        fprintf(f, "    {\"name\": \"%s\", \"iterations\": %u, \"ns_per_op\": %.3f, \"ns_median\": %.3f}%s\n",
+                results[i].name, results[i].iters, results[i].ns_per_op, results[i].ns_median,
+                i + 1 < num_results ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("[Bench] Results written to %s\n", path);
+    return 0;
+}
+
+static int bench_selected(const char *name) {
+    return !name_filter || strncmp(name, name_filter, strlen(name_filter)) == 0;
+}
+
+// Returns the number of regressions, or -1 if the baseline cannot be read.
+// Baseline cases this run should have measured but did not are counted in
+// *missing; cases the baseline does not know are listed as new.
+static int bench_compare(const char *path, double threshold, int *missing) {
+    FILE *f = fopen(path, "r");
+    char line[256];
+    int regressions = 0;
+    uint8_t in_baseline[BENCH_MAX_RESULTS] = { 0 };
+    *missing = 0;
+    if (!f) {
+        printf("[Bench] Cannot read baseline %s\n", path);
+        return -1;
+    }
+    printf("[Bench] Comparing against %s (threshold %.1f%%)\n", path, threshold);
+    while (fgets(line, sizeof(line), f)) {
+        char name[BENCH_NAME_LEN];
+        unsigned iters;
+        double base;
+        const char *p = strstr(line, "{\"name\"");
+        if (!p || sscanf(p, "{\"name\": \"%47[^\"]\", \"iterations\": %u, \"ns_per_op\": %lf", name, &iters, &base) != 3) {
+            continue;
+        }
+        size_t i;
+        for (i = 0; i < num_results; ++i) {
+            if (strcmp(results[i].name, name) == 0) break;
+        }
+        if (i == num_results) {
+            // Outside --filter is expected; otherwise the case was dropped or renamed
+            if (bench_selected(name)) {
+                printf("[Bench] %-26s base %10.1f  now    missing  MISSING\n", name, base);
+                ++*missing;
+            }
+            continue;
+        }
+        in_baseline[i] = 1;
+        double delta = base > 0 ? (results[i].ns_per_op - base) * 100.0 / base : 0.0;
+        int regressed = delta > threshold;
+        printf("[Bench] %-26s base %10.1f  now %10.1f  %+7.1f%%%s\n", name, base, results[i].ns_per_op, delta,
+               regressed ? "  REGRESSION" : "");
+        regressions += regressed;
+    }
+    fclose(f);
+    for (size_t i = 0; i < num_results; ++i) {
+        if (!in_baseline[i]) {
+            printf("[Bench] %-26s base        new  now %10.1f  NEW\n", results[i].name, results[i].ns_per_op);
+        }
+    }
+    return regressions;
+}
+
+static void vBenchTask(void *pvParameters) {
+    int status = EXIT_SUCCESS;
+    pci_init(PCI_TYPE_RC, PCI_GEN7, PCI_LANES_X16);
+    // Same prefix test as the cases: the report goes with any codec_* case
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); ++i) {
+        if (strncmp(bench_cases[i].name, "codec_", 6) == 0 && bench_selected(bench_cases[i].name)) {
+            bench_codec_report();
+            break;
+        }
+    }
+    for (size_t i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); ++i) {
+        if (!bench_selected(bench_cases[i].name)) continue;
+        bench_run_case(&bench_cases[i]);
+    }
+#ifdef SIM_HEAP_POOL
+    heap_pool_print_stats(stdout);
+#endif
+    if (bench_write_json(json_path) != 0) {
+        status = EXIT_FAILURE;
+    }
+    if (baseline_path) {
+        int missing;
+        int regressions = bench_compare(baseline_path, threshold_pct, &missing);
+        if (regressions != 0 || missing != 0) {
+            printf("[Bench] %d regression(s) beyond %.1f%%, %d baseline case(s) missing\n",
+                   regressions < 0 ? 0 : regressions, threshold_pct, missing);
+            status = EXIT_FAILURE;
+        }
+    }
+    fflush(stdout);
+    exit(status);
+}
+
+static void bench_usage(const char *prog) {
+    printf("Usage: %s [--json FILE] [--compare BASELINE] [--threshold PCT] [--scale FACTOR] [--filter PREFIX]\n", prog);
+    printf("       [--trace FILE]   sensor data for the codec_*_replay cases (default %s)\n", trace_path);
+}
+
+int main(int argc, char **argv) {
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        } else if (strcmp(argv[i], "--compare") == 0 && i + 1 < argc) {
+            baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold_pct = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--scale") == 0 && i + 1 < argc) {
+            iter_scale = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            name_filter = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_path = argv[++i];
+        } else {
+            bench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    board_init();
+    uart_init();
+    spi_init(SPI_MODE_MASTER);
+    lru_cache_init();
+    task_scheduler_init();
+    printf("[Bench] crc32c backend: %s\n", crc32c_backend());
+    codec_make_synthetic();
+    codec_load_replay(trace_path);
+    codec_encoded_len = codec_encode_all(codec_synthetic, SENSOR_CODEC_DEFAULT_RESET, 0, codec_encoded);
+    // Run inside a task so queue operations behave as they do in the simulator
+    SIM_TASK_CREATE(vBenchTask, "Bench", 1024, NULL, TASK_PRIO_PCIE + 1);
+    vTaskStartScheduler();
+    return EXIT_FAILURE;
+}
+
+// Hooks the kernel configuration asks for
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    printf("[FATAL] Stack overflow in task: %s\n", pcTaskName);
+    exit(EXIT_FAILURE);
+}
+
+void vApplicationMallocFailedHook(void) {
+    printf("[FATAL] Malloc failed!\n");
+    exit(EXIT_FAILURE);
+}
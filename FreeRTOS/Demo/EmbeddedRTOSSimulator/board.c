@@ -1,4 +1,5 @@
 #include "board.h"
+#include "sim_log.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -14,11 +15,16 @@ static size_t num_event_cbs = 0;
 void board_init(void) {
     memset(&g_board, 0, sizeof(g_board));
     num_event_cbs = 0;
-    printf("[Board] ARMv8A virtual board initialized.\n");
+    SIM_LOG("[Board] ARMv8A virtual board initialized.\n");
+}
+
+void board_restore(const struct board_state *saved) {
+    g_board = *saved;
+    num_event_cbs = 0;  // Callbacks are code, re-registered by the device restores
 }
 
 void board_simulate_event(void) {
-    printf("[Board] Simulated hardware event (interrupt).\n");
+    SIM_LOG("[Board] Simulated hardware event (interrupt).\n");
     // Call all registered event callbacks
     for (size_t i = 0; i < num_event_cbs; ++i) {
         if (event_cbs[i]) {
@@ -34,7 +40,7 @@ uint32_t board_reg_read(uint32_t addr) {
         case BOARD_REG_PCI:    return g_board.pci_reg;
         case BOARD_REG_SENSOR: return g_board.sensor_reg;
         default:
-            printf("[Board] Invalid reg read: 0x%08x\n", addr);
+            SIM_LOG("[Board] Invalid reg read: 0x%08x\n", addr);
             return 0;
     }
 }
@@ -46,10 +52,10 @@ void board_reg_write(uint32_t addr, uint32_t value) {
         case BOARD_REG_PCI:    g_board.pci_reg = value; break;
         case BOARD_REG_SENSOR: g_board.sensor_reg = value; break;
         default:
-            printf("[Board] Invalid reg write: 0x%08x\n", addr);
+            SIM_LOG("[Board] Invalid reg write: 0x%08x\n", addr);
             return;
     }
-    printf("[Board] Reg write: 0x%08x = 0x%08x\n", addr, value);
+    SIM_LOG("[Board] Reg write: 0x%08x = 0x%08x\n", addr, value);
 }
 
 void board_register_event(board_event_cb_t cb, void *context) {
@@ -57,8 +63,8 @@ void board_register_event(board_event_cb_t cb, void *context) {
         event_cbs[num_event_cbs] = cb;
         event_ctxs[num_event_cbs] = context;
         ++num_event_cbs;
-        printf("[Board] Event callback registered.\n");
+        SIM_LOG("[Board] Event callback registered.\n");
     } else {
-        printf("[Board] Event callback registration failed (full).\n");
+        SIM_LOG("[Board] Event callback registration failed (full).\n");
     }
 }
\ No newline at end of file
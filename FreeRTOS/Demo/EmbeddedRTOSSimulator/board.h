@@ -25,6 +25,8 @@ extern struct board_state g_board;
 typedef void (*board_event_cb_t)(void *context);
 
 void board_init(void);
+// Warm start: load register state without bring-up (checkpoint.c)
+void board_restore(const struct board_state *saved);
 void board_simulate_event(void);
 
 // Register read/write API
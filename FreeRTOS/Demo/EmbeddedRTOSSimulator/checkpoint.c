@@ -0,0 +1,240 @@
+#include "checkpoint.h"
+#include "task.h"
+#include "board.h"
+#include "uart.h"
+#include "spi.h"
+#include "lru_cache.h"
+#include "task_scheduler.h"
+#include "sim_time.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char *checkpoint_path = NULL;
+
+static const uint32_t section_sizes[CHECKPOINT_NUM_SECTIONS] = {
+    [CHECKPOINT_SEC_BOARD]     = sizeof(struct board_state),
+    [CHECKPOINT_SEC_UART]      = sizeof(struct uart_state),
+    [CHECKPOINT_SEC_SPI]       = sizeof(struct spi_state),
+    [CHECKPOINT_SEC_PCI]       = sizeof(struct pci_state),
+    [CHECKPOINT_SEC_PCI_TASKS] = sizeof(struct checkpoint_pci_tasks),
+    [CHECKPOINT_SEC_LRU_CACHE] = sizeof(lru_cache_t),
+};
+
+static uint64_t align_up(uint64_t v) {
+    return (v + CHECKPOINT_ALIGN - 1) / CHECKPOINT_ALIGN * CHECKPOINT_ALIGN;
+}
+
+static void task_to_name(TaskHandle_t task, char *name) {
+    const struct task_info *info = task ? task_scheduler_find_task(task) : NULL;
+    memset(name, 0, configMAX_TASK_NAME_LEN);
+    if (info) {
+        strncpy(name, info->name, configMAX_TASK_NAME_LEN - 1);
+    } else if (task) {
+        // Not created through SIM_TASK_CREATE: the target is dropped on restore
+        strncpy(name, pcTaskGetName(task), configMAX_TASK_NAME_LEN - 1);
+    }
+}
+
+static TaskHandle_t name_to_task(const char *name) {
+    const struct task_info *tasks;
+    size_t n = task_scheduler_get_tasks(&tasks);
+    if (name[0] == '\0') return NULL;
+    for (size_t i = 0; i < n; ++i) {
+        if (strncmp(tasks[i].name, name, configMAX_TASK_NAME_LEN - 1) == 0) return tasks[i].handle;
+    }
+    printf("[Checkpoint] No task named %.*s, interrupt target dropped\n", (int)configMAX_TASK_NAME_LEN - 1, name);
+    return NULL;
+}
+
+static int write_all(int fd, const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+int checkpoint_save(const char *path) {
+    struct checkpoint_header *hdr;
+    struct pci_state *pci;
+    struct uart_state *uart;
+    struct spi_state *spi;
+    struct checkpoint_pci_tasks *pci_tasks;
+    uint64_t offset = align_up(sizeof(*hdr));
+    uint8_t *image;
+    char tmp_path[512];
+    int fd, rc = 0;
+
+    for (int s = 0; s < CHECKPOINT_NUM_SECTIONS; ++s) {
+        offset = align_up(offset + section_sizes[s]);
+    }
+    image = calloc(1, offset);
+    if (!image) return -1;
+    hdr = (struct checkpoint_header *)image;
+    memcpy(hdr->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    hdr->version = CHECKPOINT_VERSION;
+    hdr->byte_order = CHECKPOINT_BYTE_ORDER;
+    hdr->header_size = sizeof(*hdr);
+    hdr->num_sections = CHECKPOINT_NUM_SECTIONS;
+    hdr->tick_rate_hz = configTICK_RATE_HZ;
+    hdr->tick = (uint32_t)xTaskGetTickCount();
+    offset = align_up(sizeof(*hdr));
+    for (int s = 0; s < CHECKPOINT_NUM_SECTIONS; ++s) {
+        hdr->sections[s].id = (uint32_t)s;
+        hdr->sections[s].size = section_sizes[s];
+        hdr->sections[s].offset = offset;
+        offset = align_up(offset + section_sizes[s]);
+    }
+#define SECTION(id) (image + hdr->sections[id].offset)
+    memcpy(SECTION(CHECKPOINT_SEC_BOARD), &g_board, sizeof(g_board));
+    // Kernel handles are per process: cleared here, recreated on restore
+    uart = (struct uart_state *)SECTION(CHECKPOINT_SEC_UART);
+    // TX rings are saved drained: whatever was queued has left on the line
+    *uart = g_uart;
+    uart->rx_queue = NULL;
+    uart->tx_tail = uart->tx_head;
+    spi = (struct spi_state *)SECTION(CHECKPOINT_SEC_SPI);
+    *spi = g_spi;
+    spi->rx_queue = NULL;
+    spi->tx_tail = spi->tx_head;
+    pci = (struct pci_state *)SECTION(CHECKPOINT_SEC_PCI);
+    pci_tasks = (struct checkpoint_pci_tasks *)SECTION(CHECKPOINT_SEC_PCI_TASKS);
+    *pci = g_pci;
+    pci->event_queue = NULL;
+    for (int v = 0; v < PCI_NUM_MSI_VECTORS; ++v) {
+        task_to_name(pci->msi[v].task, pci_tasks->msi[v]);
+        pci->msi[v].task = NULL;
+    }
+    for (int v = 0; v < PCI_NUM_MSIX_VECTORS; ++v) {
+        task_to_name(pci->msix[v].task, pci_tasks->msix[v]);
+        pci->msix[v].task = NULL;
+    }
+    for (int i = 0; i < PCI_NUM_INT_TASKS; ++i) {
+        task_to_name(pci->int_tasks[i].task, pci_tasks->int_tasks[i]);
+        pci->int_tasks[i].task = NULL;
+    }
+    lru_cache_save((lru_cache_t *)SECTION(CHECKPOINT_SEC_LRU_CACHE));
+#undef SECTION
+
+    // Write beside the target and rename, so an old snapshot is never left half overwritten
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fd = open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write_all(fd, image, offset) != 0 || fsync(fd) != 0) {
+        printf("[Checkpoint] Cannot write %s: %s\n", tmp_path, strerror(errno));
+        rc = -1;
+    }
+    if (fd >= 0) close(fd);
+    if (rc == 0 && rename(tmp_path, path) != 0) {
+        printf("[Checkpoint] Cannot rename %s to %s: %s\n", tmp_path, path, strerror(errno));
+        rc = -1;
+    }
+    if (rc != 0) {
+        unlink(tmp_path);
+    } else {
+        printf("[Checkpoint] Saved device state at tick %u to %s (%u bytes)\n",
+               (unsigned)hdr->tick, path, (unsigned)offset);
+    }
+    free(image);
+    return rc;
+}
+
+static void checkpoint_at_exit(void) {
+    // After a stack overflow or failed malloc the device state is suspect:
+    // keep the last good snapshot instead
+    if (sim_time_fatal_exit()) {
+        printf("[Checkpoint] Fatal error, %s not updated\n", checkpoint_path);
+        return;
+    }
+    checkpoint_save(checkpoint_path);
+}
+
+void checkpoint_enable(const char *path) {
+    checkpoint_path = path;
+    atexit(checkpoint_at_exit);
+}
+
+static int checkpoint_validate(const uint8_t *map, size_t size, const char *path) {
+    const struct checkpoint_header *hdr = (const struct checkpoint_header *)map;
+    if (size < sizeof(*hdr) || memcmp(hdr->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0) {
+        printf("[Checkpoint] %s is not a snapshot\n", path);
+        return -1;
+    }
+    if (hdr->version != CHECKPOINT_VERSION || hdr->byte_order != CHECKPOINT_BYTE_ORDER ||
+        hdr->header_size != sizeof(*hdr) || hdr->num_sections != CHECKPOINT_NUM_SECTIONS) {
+        printf("[Checkpoint] %s: version %u from a different build, take a new snapshot\n",
+               path, (unsigned)hdr->version);
+        return -1;
+    }
+    for (int s = 0; s < CHECKPOINT_NUM_SECTIONS; ++s) {
+        const struct checkpoint_section *sec = &hdr->sections[s];
+        if (sec->id != (uint32_t)s || sec->size != section_sizes[s] ||
+            sec->offset % CHECKPOINT_ALIGN != 0 || sec->offset > size || size - sec->offset < sec->size) {
+            printf("[Checkpoint] %s: section %d does not match this build\n", path, s);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int checkpoint_restore(const char *path) {
+    const struct checkpoint_header *hdr;
+    const struct checkpoint_pci_tasks *pci_tasks;
+    struct pci_state pci;
+    struct stat st;
+    uint8_t *map;
+    int fd = open(path, O_RDONLY);
+
+    if (fd < 0) {
+        printf("[Checkpoint] Cannot open %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("[Checkpoint] %s is empty\n", path);
+        close(fd);
+        return -1;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("[Checkpoint] Cannot map %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (checkpoint_validate(map, (size_t)st.st_size, path) != 0) {
+        munmap(map, (size_t)st.st_size);
+        return -1;
+    }
+    hdr = (const struct checkpoint_header *)map;
+#define SECTION(id) (map + hdr->sections[id].offset)
+    board_restore((const struct board_state *)SECTION(CHECKPOINT_SEC_BOARD));
+    uart_restore((const struct uart_state *)SECTION(CHECKPOINT_SEC_UART));
+    spi_restore((const struct spi_state *)SECTION(CHECKPOINT_SEC_SPI));
+    lru_cache_restore((const lru_cache_t *)SECTION(CHECKPOINT_SEC_LRU_CACHE));
+    memcpy(&pci, SECTION(CHECKPOINT_SEC_PCI), sizeof(pci));
+    pci_tasks = (const struct checkpoint_pci_tasks *)SECTION(CHECKPOINT_SEC_PCI_TASKS);
+#undef SECTION
+    for (int v = 0; v < PCI_NUM_MSI_VECTORS; ++v) {
+        pci.msi[v].task = name_to_task(pci_tasks->msi[v]);
+    }
+    for (int v = 0; v < PCI_NUM_MSIX_VECTORS; ++v) {
+        pci.msix[v].task = name_to_task(pci_tasks->msix[v]);
+    }
+    for (int i = 0; i < PCI_NUM_INT_TASKS; ++i) {
+        pci.int_tasks[i].task = name_to_task(pci_tasks->int_tasks[i]);
+    }
+    pci_restore(&pci);
+    printf("[Checkpoint] Restored device state from %s (saved at tick %u)\n", path, (unsigned)hdr->tick);
+    munmap(map, (size_t)st.st_size);
+    return 0;
+}
@@ -0,0 +1,62 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "pci.h"
+
+// Device state snapshot (--checkpoint / --restore). The file is a fixed
+// header followed by one aligned section per device, each a raw copy of the
+// module's state struct, so it can be mmap()ed and validated without parsing.
+// Host byte order and struct layout: a snapshot is only valid for the build
+// that wrote it, which the byte order and per-section sizes check.
+#define CHECKPOINT_MAGIC      "SIMCKPT"
+#define CHECKPOINT_VERSION    1
+#define CHECKPOINT_BYTE_ORDER 0x01020304u
+#define CHECKPOINT_ALIGN      64          // Section offsets, for direct mapping
+
+typedef enum {
+    CHECKPOINT_SEC_BOARD = 0,
+    CHECKPOINT_SEC_UART,
+    CHECKPOINT_SEC_SPI,
+    CHECKPOINT_SEC_PCI,
+    CHECKPOINT_SEC_PCI_TASKS,
+    CHECKPOINT_SEC_LRU_CACHE,
+    CHECKPOINT_NUM_SECTIONS
+} checkpoint_section_id_t;
+
+struct checkpoint_section {
+    uint32_t id;            // checkpoint_section_id_t
+    uint32_t size;          // sizeof() the state struct when written
+    uint64_t offset;        // From the start of the file
+};
+
+struct checkpoint_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;
+    uint32_t num_sections;
+    uint32_t tick_rate_hz;
+    uint32_t tick;          // Simulated time when the snapshot was taken
+    struct checkpoint_section sections[CHECKPOINT_NUM_SECTIONS];
+};
+
+// Task handles do not survive a restart: PCIe interrupt targets are saved by
+// task name and looked up in the task registry on restore ("" = none)
+struct checkpoint_pci_tasks {
+    char msi[PCI_NUM_MSI_VECTORS][configMAX_TASK_NAME_LEN];
+    char msix[PCI_NUM_MSIX_VECTORS][configMAX_TASK_NAME_LEN];
+    char int_tasks[PCI_NUM_INT_TASKS][configMAX_TASK_NAME_LEN];
+};
+
+// Write the snapshot at exit (--run-for, Ctrl-C), when the idle task holds
+// the scheduler suspended and no device update is half done
+void checkpoint_enable(const char *path);
+int checkpoint_save(const char *path);
+
+// Load every device from a snapshot instead of running board/UART/SPI/LRU/PCIe
+// bring-up. Call after the tasks are created, before the scheduler starts.
+int checkpoint_restore(const char *path);
+
+#endif // CHECKPOINT_H
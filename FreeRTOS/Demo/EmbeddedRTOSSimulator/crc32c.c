@@ -0,0 +1,155 @@
+#include "crc32c.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <nmmintrin.h>
+#define CRC32C_HW_NAME "sse4.2"
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC32C_HW_NAME "armv8-crc"
+#endif
+
+#define CRC32C_POLY 0x82F63B78u
+
+typedef uint32_t (*crc32c_fn)(uint32_t crc, const uint8_t *p, size_t len);
+
+static uint32_t crc32c_table[8][256];
+static int crc32c_table_ready = 0;
+
+static void crc32c_build_table(void) {
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k) {
+            c = (c >> 1) ^ (CRC32C_POLY & (0u - (c & 1)));
+        }
+        crc32c_table[0][i] = c;
+    }
+    // table[k][i]: CRC of byte i followed by k zero bytes
+    for (uint32_t i = 0; i < 256; ++i) {
+        for (int k = 1; k < 8; ++k) {
+            uint32_t c = crc32c_table[k - 1][i];
+            crc32c_table[k][i] = (c >> 8) ^ crc32c_table[0][c & 0xFF];
+        }
+    }
+    crc32c_table_ready = 1;
+}
+
+// Slice-by-8: one 8-byte word per iteration through eight tables
+static uint32_t crc32c_slice8(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xFF];
+        len--;
+    }
+    while (len >= 8) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        lo = __builtin_bswap32(lo);
+        hi = __builtin_bswap32(hi);
+#endif
+        lo ^= crc;
+        crc = crc32c_table[7][lo & 0xFF] ^ crc32c_table[6][(lo >> 8) & 0xFF] ^
+              crc32c_table[5][(lo >> 16) & 0xFF] ^ crc32c_table[4][lo >> 24] ^
+              crc32c_table[3][hi & 0xFF] ^ crc32c_table[2][(hi >> 8) & 0xFF] ^
+              crc32c_table[1][(hi >> 16) & 0xFF] ^ crc32c_table[0][hi >> 24];
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = (crc >> 8) ^ crc32c_table[0][(crc ^ *p++) & 0xFF];
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        crc = _mm_crc32_u8(crc, *p++);
+        len--;
+    }
+#ifdef __x86_64__
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = (uint32_t)_mm_crc32_u64(crc, v);
+        p += 8;
+        len -= 8;
+    }
+#endif
+    while (len >= 4) {
+        uint32_t v;
+        memcpy(&v, p, 4);
+        crc = _mm_crc32_u32(crc, v);
+        p += 4;
+        len -= 4;
+    }
+    while (len--) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+    return crc;
+}
+
+static int crc32c_hw_available(void) {
+    return __builtin_cpu_supports("sse4.2");
+}
+#elif defined(__aarch64__)
+__attribute__((target("+crc")))
+static uint32_t crc32c_hw(uint32_t crc, const uint8_t *p, size_t len) {
+    while (len && ((uintptr_t)p & 7)) {
+        crc = __crc32cb(crc, *p++);
+        len--;
+    }
+    while (len >= 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        crc = __crc32cd(crc, v);
+        p += 8;
+        len -= 8;
+    }
+    while (len--) {
+        crc = __crc32cb(crc, *p++);
+    }
+    return crc;
+}
+
+static int crc32c_hw_available(void) {
+    return (getauxval(AT_HWCAP) & HWCAP_CRC32) != 0;
+}
+#endif
+
+static uint32_t crc32c_resolve(uint32_t crc, const uint8_t *p, size_t len);
+
+// Chosen on first use; every candidate is pure, so a racing first call is harmless
+static crc32c_fn crc32c_impl = crc32c_resolve;
+static const char *crc32c_impl_name = "slice-by-8";
+
+static uint32_t crc32c_resolve(uint32_t crc, const uint8_t *p, size_t len) {
+    crc32c_fn impl = crc32c_slice8;
+    if (!crc32c_table_ready) crc32c_build_table();
+#ifdef CRC32C_HW_NAME
+    if (crc32c_hw_available()) {
+        impl = crc32c_hw;
+        crc32c_impl_name = CRC32C_HW_NAME;
+    }
+#endif
+    crc32c_impl = impl;
+    return impl(crc, p, len);
+}
+
+uint32_t crc32c(uint32_t crc, const void *data, size_t len) {
+    return ~crc32c_impl(~crc, data, len);
+}
+
+uint32_t crc32c_sw(uint32_t crc, const void *data, size_t len) {
+    if (!crc32c_table_ready) crc32c_build_table();
+    return ~crc32c_slice8(~crc, data, len);
+}
+
+const char *crc32c_backend(void) {
+    if (crc32c_impl == crc32c_resolve) crc32c(0, NULL, 0);
+    return crc32c_impl_name;
+}
@@ -0,0 +1,22 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// CRC-32C (Castagnoli, reflected polynomial 0x82F63B78), as used by iSCSI,
+// ext4 and SCTP. The first call picks the fastest backend the host CPU has:
+// SSE4.2 crc32 on x86, the ARMv8 CRC32 extension on aarch64 (Cortex-A72 on
+// the Pi 4 has it), otherwise slice-by-8 tables. All give identical results.
+//
+// Chain calls by passing the previous result as crc; start with 0.
+// crc32c(0, "123456789", 9) == 0xE3069283.
+uint32_t crc32c(uint32_t crc, const void *data, size_t len);
+
+// Table path regardless of the CPU (benchmarks, cross-checking the backends)
+uint32_t crc32c_sw(uint32_t crc, const void *data, size_t len);
+
+// "sse4.2", "armv8-crc" or "slice-by-8"
+const char *crc32c_backend(void);
+
+#endif // CRC32C_H
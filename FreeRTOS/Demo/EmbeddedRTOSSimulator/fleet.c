@@ -0,0 +1,432 @@
+#define _GNU_SOURCE     // sched_setaffinity
+#include "fleet.h"
+#include "sim_config.h"
+#include "stats_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <sched.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#define FLEET_MAX_CONFIG_ARGS 64
+
+struct fleet_instance {
+    pid_t pid;
+    int cpu;                    // Host CPU it is pinned to (-1 = not pinned)
+    int running;
+    int status;                 // waitpid() status once it has exited
+    double cpu_seconds;         // Host CPU time used, from wait4()
+};
+
+// One queue name, summed over every instance that has it
+struct fleet_queue {
+    char name[STATS_SHM_NAME_LEN];
+    uint32_t instances;
+    uint64_t waiting;
+    uint64_t length;
+    uint32_t peak;              // Highest in any instance
+    uint64_t sends;
+    uint64_t receives;
+    uint64_t send_failures;
+    uint64_t receive_failures;
+    uint64_t send_blocked_ticks;
+    uint64_t receive_blocked_ticks;
+};
+
+struct fleet_totals {
+    uint32_t reporting;         // Instances that have published at least once
+    uint32_t tick_min;
+    uint32_t tick_max;
+    uint64_t free_heap_sum;
+    uint32_t free_heap_min;
+    uint32_t min_free_heap;     // Lowest low-water mark of any instance
+    uint64_t latency_count;
+    uint64_t latency_sum;
+    uint32_t latency_max;
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+    uint64_t uart_bytes;        // TX + RX
+    uint64_t spi_bytes;
+    uint64_t pcie_irqs;
+    uint32_t num_queues;
+    struct fleet_queue queues[FLEET_MAX_QUEUES];
+};
+
+static uint32_t fleet_size = 0;
+static struct stats_shm *slots = NULL;        // Shared with every instance
+static struct fleet_instance *instances = NULL;
+static struct stats_shm_data *snapshots = NULL;
+static uint8_t *snapshot_valid = NULL;
+static int num_cpus = 0;
+static volatile sig_atomic_t stop_requested = 0;
+
+// --- Instance side ---
+
+// Extra options for one instance: line (index % lines) of --fleet-config,
+// blank lines and '#' comments skipped. Parsed like the command line, so
+// anything an instance can be given there is valid (--replay, --time-scale...).
+static int fleet_apply_config(const char *prog, uint32_t index) {
+    static char *argv[FLEET_MAX_CONFIG_ARGS + 2];
+    char *line = NULL, *chosen = NULL;
+    size_t cap = 0;
+    uint32_t lines = 0;
+    int argc = 0;
+    FILE *f = fopen(g_sim_config.fleet_config, "r");
+
+    if (!f) {
+        printf("[Fleet] Cannot open %s: %s\n", g_sim_config.fleet_config, strerror(errno));
+        return -1;
+    }
+    // Two passes: count usable lines, then take ours
+    for (int pass = 0; pass < 2 && !chosen; ++pass) {
+        uint32_t n = 0;
+        rewind(f);
+        while (getline(&line, &cap, f) > 0) {
+            char *p = line + strspn(line, " \t");
+            if (*p == '\n' || *p == '\0' || *p == '#') continue;
+            if (pass == 1 && n == index % lines) {
+                chosen = strdup(p);  // Kept: parsed options point into it
+                break;
+            }
+            n++;
+        }
+        lines = n;
+        if (lines == 0) break;
+    }
+    free(line);
+    fclose(f);
+    if (!chosen) return 0;
+    argv[argc++] = (char *)prog;
+    for (char *tok = strtok(chosen, " \t\r\n"); tok && argc <= FLEET_MAX_CONFIG_ARGS; tok = strtok(NULL, " \t\r\n")) {
+        argv[argc++] = tok;
+    }
+    argv[argc] = NULL;
+    optind = 0;     // Restart getopt for a second argument vector
+    return sim_config_parse(argc, argv);
+}
+
+static const char *fleet_absolute_path(const char *path) {
+    char resolved[PATH_MAX];
+    if (path == NULL || path[0] == '/' || realpath(path, resolved) == NULL) return path;
+    return strdup(resolved);
+}
+
+static int fleet_instance_setup(const char *prog, uint32_t index, int cpu) {
+    char dir[PATH_MAX];
+    int fd;
+
+#ifdef __linux__
+    prctl(PR_SET_PDEATHSIG, SIGTERM);   // Never outlive the launcher
+#endif
+    if (cpu >= 0) {
+        // Inherited by the task threads the Posix port creates later
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        sched_setaffinity(0, sizeof(set), &set);
+    }
+    g_sim_config.seed += index;
+    g_sim_config.source_id = (uint16_t)((g_sim_config.source_id - 1 + index) % 65535 + 1);
+    if (g_sim_config.fleet_config && fleet_apply_config(prog, index) != 0) {
+        return -1;
+    }
+    g_sim_config.fleet_size = 0;
+    g_sim_config.shm_name = NULL;       // The fleet slot replaces a named segment
+    // Inputs are shared, outputs go to the instance directory
+    g_sim_config.replay_path = fleet_absolute_path(g_sim_config.replay_path);
+    g_sim_config.restore_path = fleet_absolute_path(g_sim_config.restore_path);
+    snprintf(dir, sizeof(dir), "%s/%u", g_sim_config.fleet_dir, (unsigned)index);
+    if ((mkdir(dir, 0755) != 0 && errno != EEXIST) || chdir(dir) != 0) {
+        printf("[Fleet] Instance %u: cannot use %s: %s\n", (unsigned)index, dir, strerror(errno));
+        return -1;
+    }
+    fd = open("console.log", O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0) {
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+        close(fd);
+    }
+    stats_shm_attach(&slots[index], g_sim_config.shm_interval_ms);
+    printf("[Fleet] Instance %u of %u: pid %d, CPU %d, seed %u, source id %u\n", (unsigned)index,
+           (unsigned)fleet_size, (int)getpid(), cpu, (unsigned)g_sim_config.seed, (unsigned)g_sim_config.source_id);
+    return 0;
+}
+
+// --- Launcher side ---
+
+static struct fleet_queue *fleet_find_queue(struct fleet_totals *t, const char *name) {
+    struct fleet_queue *q;
+    for (uint32_t i = 0; i < t->num_queues; ++i) {
+        if (strcmp(t->queues[i].name, name) == 0) return &t->queues[i];
+    }
+    if (t->num_queues == FLEET_MAX_QUEUES) return NULL;
+    q = &t->queues[t->num_queues++];
+    snprintf(q->name, sizeof(q->name), "%s", name);
+    return q;
+}
+
+static void fleet_collect(struct fleet_totals *t) {
+    memset(t, 0, sizeof(*t));
+    for (uint32_t i = 0; i < fleet_size; ++i) {
+        const struct stats_shm_data *d = &snapshots[i];
+        // A slot stays zero until its instance attaches; a busy writer is
+        // simply skipped this round
+        snapshot_valid[i] = __atomic_load_n(&slots[i].magic, __ATOMIC_ACQUIRE) == STATS_SHM_MAGIC &&
+                            stats_shm_read(&slots[i], &snapshots[i]) == 0 && d->update_count > 0;
+        if (!snapshot_valid[i]) continue;
+        if (t->reporting == 0 || d->tick < t->tick_min) t->tick_min = d->tick;
+        if (t->reporting == 0 || d->tick > t->tick_max) t->tick_max = d->tick;
+        if (t->reporting == 0 || d->free_heap < t->free_heap_min) t->free_heap_min = d->free_heap;
+        if (t->reporting == 0 || d->min_free_heap < t->min_free_heap) t->min_free_heap = d->min_free_heap;
+        if (d->latency_max > t->latency_max) t->latency_max = d->latency_max;
+        t->reporting++;
+        t->free_heap_sum += d->free_heap;
+        t->latency_count += d->latency_count;
+        t->latency_sum += d->latency_sum;
+        t->cache_hits += d->cache_hits;
+        t->cache_misses += d->cache_misses;
+        t->uart_bytes += (uint64_t)d->uart_tx_bytes + d->uart_rx_bytes;
+        t->spi_bytes += (uint64_t)d->spi_tx_bytes + d->spi_rx_bytes;
+        for (int k = 0; k < STATS_SHM_PCIE_INT_TYPES; ++k) {
+            t->pcie_irqs += d->pcie_irqs[k];
+        }
+        for (uint32_t k = 0; k < d->num_queues && k < STATS_SHM_MAX_QUEUES; ++k) {
+            const struct stats_shm_queue *sq = &d->queues[k];
+            struct fleet_queue *q = fleet_find_queue(t, sq->name);
+            if (!q) continue;
+            q->instances++;
+            q->waiting += sq->waiting;
+            q->length += sq->length;
+            if (sq->peak > q->peak) q->peak = sq->peak;
+            q->sends += sq->sends;
+            q->receives += sq->receives;
+            q->send_failures += sq->send_failures;
+            q->receive_failures += sq->receive_failures;
+            q->send_blocked_ticks += sq->send_blocked_ticks;
+            q->receive_blocked_ticks += sq->receive_blocked_ticks;
+        }
+    }
+}
+
+static double fleet_ratio(uint64_t num, uint64_t den) {
+    return den ? (double)num / (double)den : 0.0;
+}
+
+static void fleet_print_line(const struct fleet_totals *t, const struct fleet_totals *prev, double elapsed, double dt) {
+    uint64_t waiting = 0;
+    uint32_t peak = 0;
+    for (uint32_t i = 0; i < t->num_queues; ++i) {
+        waiting += t->queues[i].waiting;
+        if (t->queues[i].peak > peak) peak = t->queues[i].peak;
+    }
+    printf("[Fleet] %.1f s: %u/%u reporting, ticks %u-%u, %.1f deliveries/s, latency avg %.2f max %u ticks, "
+           "heap free min %u avg %.0f, %llu queued (peak %u)\n",
+           elapsed, (unsigned)t->reporting, (unsigned)fleet_size, (unsigned)t->tick_min, (unsigned)t->tick_max,
+           dt > 0 && t->latency_count >= prev->latency_count ? (double)(t->latency_count - prev->latency_count) / dt : 0.0,
+           fleet_ratio(t->latency_sum, t->latency_count), (unsigned)t->latency_max,
+           (unsigned)t->free_heap_min, fleet_ratio(t->free_heap_sum, t->reporting),
+           (unsigned long long)waiting, (unsigned)peak);
+    fflush(stdout);
+}
+
+static void fleet_report(FILE *f, const struct fleet_totals *t, double elapsed) {
+    double cpu_total = 0.0;
+    for (uint32_t i = 0; i < fleet_size; ++i) {
+        cpu_total += instances[i].cpu_seconds;
+    }
+    fprintf(f, "Fleet report: %u instances on %d host CPUs, %.1f s wall time\n",
+            (unsigned)fleet_size, num_cpus, elapsed);
+    fprintf(f, "  Reporting instances: %u of %u, simulated ticks %u-%u\n",
+            (unsigned)t->reporting, (unsigned)fleet_size, (unsigned)t->tick_min, (unsigned)t->tick_max);
+    fprintf(f, "  Sensor deliveries:   %llu (%.1f/s), latency avg %.2f max %u ticks\n",
+            (unsigned long long)t->latency_count, elapsed > 0 ? t->latency_count / elapsed : 0.0,
+            fleet_ratio(t->latency_sum, t->latency_count), (unsigned)t->latency_max);
+    fprintf(f, "  Device traffic:      UART %llu bytes, SPI %llu bytes, PCIe %llu interrupts\n",
+            (unsigned long long)t->uart_bytes, (unsigned long long)t->spi_bytes, (unsigned long long)t->pcie_irqs);
+    fprintf(f, "  LRU cache:           %.1f%% hits of %llu lookups\n",
+            100.0 * fleet_ratio(t->cache_hits, t->cache_hits + t->cache_misses),
+            (unsigned long long)(t->cache_hits + t->cache_misses));
+    fprintf(f, "  FreeRTOS heap free:  min %u avg %.0f, lowest ever %u bytes\n", (unsigned)t->free_heap_min,
+            fleet_ratio(t->free_heap_sum, t->reporting), (unsigned)t->min_free_heap);
+    fprintf(f, "  Host CPU:            %.2f s (%.1f%% of %d CPUs), %.1f deliveries per CPU-second\n",
+            cpu_total, elapsed > 0 && num_cpus ? 100.0 * cpu_total / (elapsed * num_cpus) : 0.0, num_cpus,
+            cpu_total > 0 ? t->latency_count / cpu_total : 0.0);
+    fprintf(f, "Queues (summed over instances):\n");
+    fprintf(f, "  %-18s %5s %13s %5s %10s %10s %8s %8s %10s %10s\n", "queue", "inst", "waiting/len", "peak",
+            "sends", "recvs", "full", "empty", "blk_tx", "blk_rx");
+    for (uint32_t i = 0; i < t->num_queues; ++i) {
+        const struct fleet_queue *q = &t->queues[i];
+        fprintf(f, "  %-18s %5u %6llu/%-6llu %5u %10llu %10llu %8llu %8llu %10llu %10llu\n", q->name,
+                (unsigned)q->instances, (unsigned long long)q->waiting, (unsigned long long)q->length, (unsigned)q->peak,
+                (unsigned long long)q->sends, (unsigned long long)q->receives,
+                (unsigned long long)q->send_failures, (unsigned long long)q->receive_failures,
+                (unsigned long long)q->send_blocked_ticks, (unsigned long long)q->receive_blocked_ticks);
+    }
+    fprintf(f, "Instances:\n");
+    fprintf(f, "  %5s %8s %4s %10s %10s %8s %7s %10s %8s %s\n", "index", "pid", "cpu", "tick", "deliveries",
+            "lat avg", "lat max", "heap min", "cpu s", "exit");
+    for (uint32_t i = 0; i < fleet_size; ++i) {
+        const struct fleet_instance *in = &instances[i];
+        const struct stats_shm_data *d = &snapshots[i];
+        char exit_str[32];
+        if (in->running) snprintf(exit_str, sizeof(exit_str), "running");
+        else if (WIFEXITED(in->status)) snprintf(exit_str, sizeof(exit_str), "%d", WEXITSTATUS(in->status));
+        else snprintf(exit_str, sizeof(exit_str), "signal %d", WTERMSIG(in->status));
+        if (!snapshot_valid[i]) {
+            fprintf(f, "  %5u %8d %4d %10s %10s %8s %7s %10s %8.2f %s\n", (unsigned)i, (int)in->pid, in->cpu,
+                    "-", "-", "-", "-", "-", in->cpu_seconds, exit_str);
+            continue;
+        }
+        fprintf(f, "  %5u %8d %4d %10u %10u %8.2f %7u %10u %8.2f %s\n", (unsigned)i, (int)in->pid, in->cpu,
+                (unsigned)d->tick, (unsigned)d->latency_count, fleet_ratio(d->latency_sum, d->latency_count),
+                (unsigned)d->latency_max, (unsigned)d->min_free_heap, in->cpu_seconds, exit_str);
+    }
+}
+
+static void fleet_signal_handler(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static double fleet_elapsed(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int fleet_supervise(void) {
+    static struct fleet_totals totals, prev;
+    struct sigaction sa = { 0 };
+    struct timespec start;
+    uint32_t alive = fleet_size;
+    uint32_t silent = 0;
+    double last = 0.0;
+    int failed = 0;
+    char path[PATH_MAX];
+    FILE *f;
+
+    sa.sa_handler = fleet_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (alive > 0) {
+        struct timespec ts = { (time_t)(g_sim_config.fleet_interval_ms / 1000),
+                               (long)(g_sim_config.fleet_interval_ms % 1000) * 1000000L };
+        struct rusage ru;
+        int status;
+        pid_t pid;
+        double now;
+
+        nanosleep(&ts, NULL);
+        if (stop_requested == 1) {
+            // Ctrl-C reaches the instances directly; kill(1)/SIGTERM is forwarded.
+            // Either way they stop at their next idle point and write their reports.
+            for (uint32_t i = 0; i < fleet_size; ++i) {
+                if (instances[i].running) kill(instances[i].pid, SIGTERM);
+            }
+            stop_requested = 2;
+        }
+        while ((pid = wait4(-1, &status, WNOHANG, &ru)) > 0) {
+            for (uint32_t i = 0; i < fleet_size; ++i) {
+                if (instances[i].pid != pid) continue;
+                instances[i].running = 0;
+                instances[i].status = status;
+                instances[i].cpu_seconds = ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+                                           ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+                if (!WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) failed++;
+                alive--;
+            }
+        }
+        now = fleet_elapsed(&start);
+        fleet_collect(&totals);
+        fleet_print_line(&totals, &prev, now, now - last);
+        prev = totals;
+        last = now;
+    }
+    printf("\n");
+    fleet_report(stdout, &totals, last);
+    snprintf(path, sizeof(path), "%s/report.txt", g_sim_config.fleet_dir);
+    f = fopen(path, "w");
+    if (f) {
+        fleet_report(f, &totals, last);
+        fclose(f);
+        printf("[Fleet] Report written to %s\n", path);
+    }
+    // StatsShm publishes as soon as the scheduler runs: an instance without a
+    // snapshot never got that far (kernel objects or heap at start-up)
+    for (uint32_t i = 0; i < fleet_size; ++i) {
+        silent += !snapshot_valid[i];
+    }
+    if (silent) {
+        printf("[Fleet] %u instance(s) never published a snapshot\n", (unsigned)silent);
+    }
+    if (failed) {
+        printf("[Fleet] %d instance(s) failed, see %s/<index>/console.log\n", failed, g_sim_config.fleet_dir);
+    }
+    return failed || silent ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int fleet_launch(const char *prog) {
+    static int cpus[CPU_SETSIZE];
+    cpu_set_t allowed;
+    int status;
+
+    fleet_size = g_sim_config.fleet_size;
+    // Round robin over the CPUs we may use, so `taskset -c 0-3` limits the fleet to 4 cores
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &allowed)) cpus[num_cpus++] = c;
+        }
+    }
+    if (mkdir(g_sim_config.fleet_dir, 0755) != 0 && errno != EEXIST) {
+        printf("[Fleet] Cannot create %s: %s\n", g_sim_config.fleet_dir, strerror(errno));
+        return -1;
+    }
+    slots = mmap(NULL, fleet_size * sizeof(struct stats_shm), PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    instances = calloc(fleet_size, sizeof(*instances));
+    snapshots = calloc(fleet_size, sizeof(*snapshots));
+    snapshot_valid = calloc(fleet_size, 1);
+    if (slots == MAP_FAILED || !instances || !snapshots || !snapshot_valid) {
+        printf("[Fleet] Cannot allocate %u instance slots\n", (unsigned)fleet_size);
+        return -1;
+    }
+    printf("[Fleet] Starting %u instances on %d host CPUs, output in %s/<index>/\n",
+           (unsigned)fleet_size, num_cpus, g_sim_config.fleet_dir);
+    fflush(stdout);
+    for (uint32_t i = 0; i < fleet_size; ++i) {
+        int cpu = num_cpus ? cpus[i % num_cpus] : -1;
+        pid_t pid = fork();
+        if (pid == 0) {
+            return fleet_instance_setup(prog, i, cpu);
+        }
+        if (pid < 0) {
+            printf("[Fleet] fork() failed after %u instances: %s\n", (unsigned)i, strerror(errno));
+            for (uint32_t k = 0; k < i; ++k) {
+                kill(instances[k].pid, SIGTERM);
+            }
+            fleet_size = i;     // Still reap and report the ones that started
+            stop_requested = 2;
+            break;
+        }
+        instances[i].pid = pid;
+        instances[i].cpu = cpu;
+        instances[i].running = 1;
+    }
+    status = fleet_supervise();
+    exit(fleet_size < g_sim_config.fleet_size ? EXIT_FAILURE : status);
+}
@@ -0,0 +1,22 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdint.h>
+
+// Fleet mode (--fleet=N): the launcher forks N simulator instances before any
+// FreeRTOS object exists, so each child runs its own scheduler and devices.
+// Instance i gets seed + i and source id + i, is pinned to the i-th host CPU
+// the launcher may use (round robin), runs in DIR/i (console.log and every
+// relative output file land there), and publishes its stats into slot i of a
+// shared stats_shm array. The launcher only aggregates: a combined line every
+// interval and a full report (DIR/report.txt) when the instances are done.
+#define FLEET_MAX_INSTANCES         1024
+#define FLEET_DEFAULT_DIR           "fleet"
+#define FLEET_DEFAULT_INTERVAL_MS   1000
+#define FLEET_MAX_QUEUES            16      // Distinct queue names in the report
+
+// Returns in each child (0) with g_sim_config adjusted for the instance, or
+// -1 if the fleet could not be started. The launcher itself never returns.
+int fleet_launch(const char *prog);
+
+#endif // FLEET_H
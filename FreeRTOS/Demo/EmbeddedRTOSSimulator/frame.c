@@ -0,0 +1,113 @@
+#include "frame.h"
+#include "crc32c.h"
+#include <string.h>
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static uint16_t get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+size_t frame_seal(uint8_t *out, size_t cap, uint8_t type, uint16_t seq, uint16_t len) {
+    size_t total = (size_t)FRAME_OVERHEAD + len;
+    if (len > FRAME_MAX_PAYLOAD || cap < total) return 0;
+    out[0] = FRAME_SYNC;
+    out[1] = type;
+    put_le16(out + 2, seq);
+    put_le16(out + 4, len);
+    put_le32(out + FRAME_HEADER_SIZE + len, crc32c(0, out, FRAME_HEADER_SIZE + len));
+    return total;
+}
+
+size_t frame_encode(uint8_t *out, size_t cap, uint8_t type, uint16_t seq, const void *payload, uint16_t len) {
+    if (len > FRAME_MAX_PAYLOAD || cap < (size_t)FRAME_OVERHEAD + len) return 0;
+    if (len) memcpy(out + FRAME_HEADER_SIZE, payload, len);
+    return frame_seal(out, cap, type, seq, len);
+}
+
+size_t frame_encode_sensor(uint8_t *out, size_t cap, uint16_t seq, const sensor_msg_t *msg) {
+    uint8_t payload[FRAME_SENSOR_PAYLOAD];
+    put_le32(payload, (uint32_t)msg->sensor_value);
+    put_le32(payload + 4, msg->timestamp);
+    return frame_encode(out, cap, FRAME_TYPE_SENSOR, seq, payload, sizeof(payload));
+}
+
+int frame_decode_sensor(const struct frame *f, sensor_msg_t *msg) {
+    if (f->type != FRAME_TYPE_SENSOR || f->len != FRAME_SENSOR_PAYLOAD) return -1;
+    msg->sensor_value = (int32_t)get_le32(f->payload);
+    msg->timestamp = get_le32(f->payload + 4);
+    return 0;
+}
+
+void frame_parser_init(struct frame_parser *p) {
+    memset(p, 0, sizeof(*p));
+}
+
+static void parser_drop(struct frame_parser *p, size_t n) {
+    memmove(p->buf, p->buf + n, p->fill - n);
+    p->fill -= n;
+}
+
+int frame_parse(struct frame_parser *p, const uint8_t **data, size_t *len, struct frame *out) {
+    if (p->consumed) {
+        parser_drop(p, p->consumed);
+        p->consumed = 0;
+    }
+    for (;;) {
+        size_t need = FRAME_HEADER_SIZE;
+        size_t skip = 0;
+        while (skip < p->fill && p->buf[skip] != FRAME_SYNC) skip++;
+        if (skip) {
+            p->skipped += skip;
+            parser_drop(p, skip);
+        }
+        if (p->fill >= FRAME_HEADER_SIZE) {
+            uint16_t plen = get_le16(p->buf + 4);
+            if (plen > FRAME_MAX_PAYLOAD) {
+                // Not a header after all: resync past this sync byte
+                p->skipped++;
+                parser_drop(p, 1);
+                continue;
+            }
+            need = (size_t)FRAME_OVERHEAD + plen;
+            if (p->fill >= need) {
+                size_t body = need - FRAME_CRC_SIZE;
+                if (crc32c(0, p->buf, body) != get_le32(p->buf + body)) {
+                    p->crc_errors++;
+                    p->skipped++;
+                    parser_drop(p, 1);
+                    continue;
+                }
+                out->type = p->buf[1];
+                out->seq = get_le16(p->buf + 2);
+                out->len = plen;
+                out->payload = p->buf + FRAME_HEADER_SIZE;
+                p->consumed = need;
+                p->frames++;
+                return 1;
+            }
+        }
+        if (*len == 0) return 0;
+        // Take only what the current frame still needs, so the buffer never overflows
+        need -= p->fill;
+        if (need > *len) need = *len;
+        memcpy(p->buf + p->fill, *data, need);
+        p->fill += need;
+        *data += need;
+        *len -= need;
+    }
+}
@@ -0,0 +1,62 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "task_scheduler.h"
+
+// Binary link frame used on UART, SPI and PCIe (all fields little-endian):
+//
+//   0  sync     0x5A
+//   1  type     FRAME_TYPE_*
+//   2  seq      u16, per sender, wraps
+//   4  len      u16, payload bytes (at most FRAME_MAX_PAYLOAD)
+//   6  payload
+//   6+len crc   u32 CRC-32C over sync..payload
+//
+// A sensor message is 18 bytes on the wire, against 25-30 for the old
+// "Sensor value: %d at %u" text, and needs no formatting or parsing.
+#define FRAME_SYNC              0x5A
+#define FRAME_HEADER_SIZE       6
+#define FRAME_CRC_SIZE          4
+#define FRAME_OVERHEAD          (FRAME_HEADER_SIZE + FRAME_CRC_SIZE)
+#define FRAME_MAX_PAYLOAD       64
+#define FRAME_MAX_SIZE          (FRAME_OVERHEAD + FRAME_MAX_PAYLOAD)
+
+#define FRAME_TYPE_SENSOR       1   // sensor_msg_t: i32 value, u32 timestamp
+#define FRAME_TYPE_SENSOR_BATCH 2   // sensor_codec records, whole records only
+#define FRAME_SENSOR_PAYLOAD    8
+#define FRAME_MAX_BATCH         255 // Samples in one batch frame
+
+struct frame {
+    uint8_t type;
+    uint16_t seq;
+    uint16_t len;
+    const uint8_t *payload;     // Into the parser buffer, valid until the next frame_parse()
+};
+
+// Byte-stream decoder: finds the sync byte, checks length and CRC, and
+// resynchronises one byte past a bad frame. Holds at most one frame.
+struct frame_parser {
+    uint8_t buf[FRAME_MAX_SIZE];
+    size_t fill;
+    size_t consumed;            // Frame returned last call, dropped on the next
+    uint32_t frames;            // Good frames
+    uint32_t crc_errors;        // Complete frames with a CRC mismatch
+    uint32_t skipped;           // Bytes discarded while hunting for a frame
+};
+
+// Returns the frame size written to out, or 0 if it does not fit in cap
+size_t frame_encode(uint8_t *out, size_t cap, uint8_t type, uint16_t seq, const void *payload, uint16_t len);
+// Same, for a payload already written at out + FRAME_HEADER_SIZE
+size_t frame_seal(uint8_t *out, size_t cap, uint8_t type, uint16_t seq, uint16_t len);
+size_t frame_encode_sensor(uint8_t *out, size_t cap, uint16_t seq, const sensor_msg_t *msg);
+
+void frame_parser_init(struct frame_parser *p);
+// Consumes bytes from *data/*len; returns 1 as soon as a good frame is
+// complete (call again for the rest of the input), 0 once input runs out.
+int frame_parse(struct frame_parser *p, const uint8_t **data, size_t *len, struct frame *out);
+// 0 if f is a well-formed sensor frame
+int frame_decode_sensor(const struct frame *f, sensor_msg_t *msg);
+
+#endif // FRAME_H
@@ -0,0 +1,242 @@
+// EmbeddedRTOSSimulator - heap_pool.c
+// pvPortMalloc/vPortFree backend with segregated size-class pools.
+// Linked instead of heap_4.o when building with `make HEAP=pool`.
+#include "FreeRTOS.h"
+#include "task.h"
+#include "heap_pool.h"
+#include <string.h>
+
+#if configSUPPORT_DYNAMIC_ALLOCATION == 0
+#error heap_pool.c requires configSUPPORT_DYNAMIC_ALLOCATION
+#endif
+
+#define ALIGN_UP(x) (((x) + portBYTE_ALIGNMENT_MASK) & ~((size_t)portBYTE_ALIGNMENT_MASK))
+
+// General heap block header; the top bit of size marks an allocated block
+typedef struct general_block {
+    struct general_block *next;
+    size_t size; // Including header
+} general_block_t;
+
+#define GENERAL_HDR      ALIGN_UP(sizeof(general_block_t))
+#define GENERAL_MIN      (GENERAL_HDR * 2)
+#define GENERAL_ALLOCATED ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+static const uint32_t class_size[HEAP_POOL_NUM_CLASSES] = HEAP_POOL_CLASS_SIZES;
+static const uint32_t class_blocks[HEAP_POOL_NUM_CLASSES] = HEAP_POOL_CLASS_BLOCKS;
+
+static uint8_t ucHeap[configTOTAL_HEAP_SIZE] __attribute__((aligned(portBYTE_ALIGNMENT)));
+
+static uint8_t *class_start[HEAP_POOL_NUM_CLASSES + 1]; // class_start[N] = start of general heap
+static void *class_free[HEAP_POOL_NUM_CLASSES];
+static general_block_t *general_free_list;
+static uint8_t *general_end;
+static int initialised = 0;
+
+static struct heap_pool_stats stats;
+static size_t free_bytes;
+static size_t min_free_bytes;
+
+static void heap_pool_init(void) {
+    uint8_t *p = ucHeap;
+    for (int c = 0; c < HEAP_POOL_NUM_CLASSES; ++c) {
+        uint32_t bsize = (uint32_t)ALIGN_UP(class_size[c]);
+        class_start[c] = p;
+        class_free[c] = NULL;
+        // Thread the free list through the blocks, lowest address first
+        for (uint32_t i = class_blocks[c]; i-- > 0;) {
+            void **blk = (void **)(p + (size_t)i * bsize);
+            *blk = class_free[c];
+            class_free[c] = blk;
+        }
+        p += (size_t)class_blocks[c] * bsize;
+        stats.classes[c].block_size = bsize;
+        stats.classes[c].blocks = class_blocks[c];
+    }
+    class_start[HEAP_POOL_NUM_CLASSES] = p;
+    general_end = ucHeap + sizeof(ucHeap);
+    general_free_list = NULL;
+    if (general_end - p >= (ptrdiff_t)GENERAL_MIN) {
+        general_free_list = (general_block_t *)p;
+        general_free_list->next = NULL;
+        general_free_list->size = (size_t)(general_end - p);
+        stats.general_size = general_free_list->size;
+    }
+    free_bytes = min_free_bytes = sizeof(ucHeap);
+    initialised = 1;
+}
+
+static void *general_alloc(size_t wanted) {
+    general_block_t *prev = NULL, *blk;
+    size_t need = ALIGN_UP(wanted) + GENERAL_HDR;
+    if (wanted >= GENERAL_ALLOCATED) return NULL;
+    for (blk = general_free_list; blk; prev = blk, blk = blk->next) {
+        if (blk->size < need) continue;
+        if (blk->size - need >= GENERAL_MIN) {
+            // Split: the tail stays on the free list in address order
+            general_block_t *rest = (general_block_t *)((uint8_t *)blk + need);
+            rest->size = blk->size - need;
+            rest->next = blk->next;
+            blk->size = need;
+            blk->next = rest;
+        }
+        if (prev) prev->next = blk->next;
+        else general_free_list = blk->next;
+        blk->next = NULL;
+        free_bytes -= blk->size;
+        stats.bytes_in_use += blk->size;
+        blk->size |= GENERAL_ALLOCATED;
+        stats.general_allocs++;
+        return (uint8_t *)blk + GENERAL_HDR;
+    }
+    return NULL;
+}
+
+static void general_free(void *pv) {
+    general_block_t *blk = (general_block_t *)((uint8_t *)pv - GENERAL_HDR);
+    general_block_t *prev = NULL, *cur = general_free_list;
+    if ((blk->size & GENERAL_ALLOCATED) == 0) return; // Double free
+    blk->size &= ~GENERAL_ALLOCATED;
+    free_bytes += blk->size;
+    stats.bytes_in_use -= blk->size;
+    stats.general_frees++;
+    while (cur && cur < blk) {
+        prev = cur;
+        cur = cur->next;
+    }
+    // Merge with the following block, then with the preceding one
+    if (cur && (uint8_t *)blk + blk->size == (uint8_t *)cur) {
+        blk->size += cur->size;
+        blk->next = cur->next;
+    } else {
+        blk->next = cur;
+    }
+    if (prev && (uint8_t *)prev + prev->size == (uint8_t *)blk) {
+        prev->size += blk->size;
+        prev->next = blk->next;
+    } else if (prev) {
+        prev->next = blk;
+    } else {
+        general_free_list = blk;
+    }
+}
+
+void *pvPortMalloc(size_t xWantedSize) {
+    void *pv = NULL;
+    vTaskSuspendAll();
+    {
+        if (!initialised) {
+            heap_pool_init();
+        }
+        if (xWantedSize > 0) {
+            int c = 0;
+            while (c < HEAP_POOL_NUM_CLASSES && class_size[c] < xWantedSize) ++c;
+            if (c < HEAP_POOL_NUM_CLASSES && class_free[c] == NULL) {
+                stats.classes[c].overflows++;
+            }
+            for (; c < HEAP_POOL_NUM_CLASSES; ++c) {
+                struct heap_pool_class_stats *cs = &stats.classes[c];
+                if (class_free[c] == NULL) continue;
+                pv = class_free[c];
+                class_free[c] = *(void **)pv;
+                cs->allocs++;
+                if (++cs->in_use > cs->peak_in_use) cs->peak_in_use = cs->in_use;
+                free_bytes -= cs->block_size;
+                stats.bytes_in_use += cs->block_size;
+                break;
+            }
+            if (pv == NULL) {
+                pv = general_alloc(xWantedSize);
+            }
+            if (pv == NULL) {
+                stats.failures++;
+            } else {
+                if (free_bytes < min_free_bytes) min_free_bytes = free_bytes;
+                if (stats.bytes_in_use > stats.peak_bytes_in_use) stats.peak_bytes_in_use = stats.bytes_in_use;
+            }
+        }
+        traceMALLOC(pv, xWantedSize);
+    }
+    (void)xTaskResumeAll();
+#if configUSE_MALLOC_FAILED_HOOK == 1
+    if (pv == NULL && xWantedSize > 0) {
+        vApplicationMallocFailedHook();
+    }
+#endif
+    return pv;
+}
+
+void vPortFree(void *pv) {
+    uint8_t *p = pv;
+    if (pv == NULL) return;
+    vTaskSuspendAll();
+    {
+        if (p >= class_start[0] && p < class_start[HEAP_POOL_NUM_CLASSES]) {
+            // Pool block: the owning class follows from the address alone
+            int c = 0;
+            while (p >= class_start[c + 1]) ++c;
+            *(void **)pv = class_free[c];
+            class_free[c] = pv;
+            stats.classes[c].frees++;
+            stats.classes[c].in_use--;
+            free_bytes += stats.classes[c].block_size;
+            stats.bytes_in_use -= stats.classes[c].block_size;
+        } else if (p > class_start[HEAP_POOL_NUM_CLASSES] && p < general_end) {
+            general_free(pv);
+        }
+        traceFREE(pv, 0);
+    }
+    (void)xTaskResumeAll();
+}
+
+size_t xPortGetFreeHeapSize(void) {
+    return initialised ? free_bytes : sizeof(ucHeap);
+}
+
+size_t xPortGetMinimumEverFreeHeapSize(void) {
+    return initialised ? min_free_bytes : sizeof(ucHeap);
+}
+
+void vPortInitialiseBlocks(void) {
+    // Only required when static memory is not cleared (as heap_4)
+}
+
+void heap_pool_get_stats(struct heap_pool_stats *out) {
+    vTaskSuspendAll();
+    {
+        if (!initialised) {
+            heap_pool_init();
+        }
+        stats.general_free = 0;
+        stats.general_largest_free = 0;
+        stats.general_free_blocks = 0;
+        for (general_block_t *blk = general_free_list; blk; blk = blk->next) {
+            stats.general_free += blk->size;
+            stats.general_free_blocks++;
+            if (blk->size > stats.general_largest_free) stats.general_largest_free = blk->size;
+        }
+        stats.fragmentation_pct = stats.general_free
+            ? (uint32_t)(100 - (stats.general_largest_free * 100) / stats.general_free)
+            : 0;
+        *out = stats;
+    }
+    (void)xTaskResumeAll();
+}
+
+void heap_pool_print_stats(FILE *f) {
+    struct heap_pool_stats st;
+    heap_pool_get_stats(&st);
+    fprintf(f, "[HeapPool] in use %lu bytes (peak %lu), min ever free %lu, failures %u\n",
+            (unsigned long)st.bytes_in_use, (unsigned long)st.peak_bytes_in_use,
+            (unsigned long)xPortGetMinimumEverFreeHeapSize(), (unsigned)st.failures);
+    for (int c = 0; c < HEAP_POOL_NUM_CLASSES; ++c) {
+        const struct heap_pool_class_stats *cs = &st.classes[c];
+        fprintf(f, "  class %4u: %u/%u used (peak %u) allocs=%u frees=%u overflows=%u\n",
+                (unsigned)cs->block_size, (unsigned)cs->in_use, (unsigned)cs->blocks, (unsigned)cs->peak_in_use,
+                (unsigned)cs->allocs, (unsigned)cs->frees, (unsigned)cs->overflows);
+    }
+    fprintf(f, "  general: %lu/%lu free, largest block %lu, %u free blocks, fragmentation %u%%, allocs=%u frees=%u\n",
+            (unsigned long)st.general_free, (unsigned long)st.general_size, (unsigned long)st.general_largest_free,
+            (unsigned)st.general_free_blocks, (unsigned)st.fragmentation_pct,
+            (unsigned)st.general_allocs, (unsigned)st.general_frees);
+}
@@ -0,0 +1,46 @@
+#ifndef HEAP_POOL_H
+#define HEAP_POOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Size-class pool allocator (make HEAP=pool), an alternative to heap_4.
+// Requests up to the largest class come from fixed-size block pools with O(1)
+// alloc/free; a full class overflows into the next larger one. Larger blocks
+// come from a first-fit, coalescing general heap in the remainder of the
+// configTOTAL_HEAP_SIZE arena. Classes can be overridden in FreeRTOSConfig.h.
+#ifndef HEAP_POOL_CLASS_SIZES
+#define HEAP_POOL_NUM_CLASSES  5
+#define HEAP_POOL_CLASS_SIZES  { 32, 64, 128, 256, 512 }
+#define HEAP_POOL_CLASS_BLOCKS { 8, 8, 8, 8, 4 }
+#endif
+
+struct heap_pool_class_stats {
+    uint32_t block_size;
+    uint32_t blocks;
+    uint32_t in_use;
+    uint32_t peak_in_use;
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t overflows;   // Requests for this class served elsewhere because it was full
+};
+
+struct heap_pool_stats {
+    struct heap_pool_class_stats classes[HEAP_POOL_NUM_CLASSES];
+    size_t general_size;
+    size_t general_free;
+    size_t general_largest_free;
+    uint32_t general_free_blocks;
+    uint32_t general_allocs;
+    uint32_t general_frees;
+    uint32_t failures;
+    size_t bytes_in_use;
+    size_t peak_bytes_in_use;
+    uint32_t fragmentation_pct;  // 100 * (1 - largest free block / free bytes), general heap
+};
+
+void heap_pool_get_stats(struct heap_pool_stats *stats);
+void heap_pool_print_stats(FILE *f);
+
+#endif // HEAP_POOL_H
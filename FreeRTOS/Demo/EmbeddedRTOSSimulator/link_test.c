@@ -0,0 +1,92 @@
+// Link model regression test (make test): pushes far more frames than the
+// UART/SPI rings hold through protocol_link_send() and checks that every SPI
+// loopback and PCIe copy decodes back to what was sent.
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "board.h"
+#include "uart.h"
+#include "spi.h"
+#include "pci.h"
+#include "task_scheduler.h"
+#include "sim_alloc.h"
+#include "frame.h"
+#include "sensor_codec.h"
+#include "protocol_link.h"
+
+#define TEST_FRAMES 2000   // Each ring holds 127 bytes, about 7 sensor frames
+#define TEST_BATCH  10     // Samples per batch frame in the second half
+
+static int failures = 0;
+
+static void check(int ok, const char *what, unsigned seq) {
+    if (ok) return;
+    if (failures++ < 10) printf("[LinkTest] FAIL frame %u: %s\n", seq, what);
+}
+
+static void send_and_check(const uint8_t *frame, size_t n, uint16_t seq, protocol_log_t *log) {
+    protocol_link_send(frame, n, seq, log);
+    check(log->loopback_ok, "loopback copy did not decode", seq);
+    check(log->crc_errors == 0, "CRC errors", seq);
+    check(log->link_errors == 0, "short write", seq);
+}
+
+static void vLinkTestTask(void *pvParameters) {
+    static struct sensor_encoder enc;
+    uint8_t frame[FRAME_MAX_SIZE];
+    uint8_t *payload = frame + FRAME_HEADER_SIZE;
+    protocol_log_t log = { 0 };
+    uint16_t seq = 0;
+
+    pci_init(PCI_TYPE_RC, PCI_GEN7, PCI_LANES_X16);
+    protocol_link_init();
+    // Uncompressed frames, one sample each
+    for (unsigned i = 0; i < TEST_FRAMES / 2; ++i, ++seq) {
+        log.msg.sensor_value = (int)(i * 37 % 1000);
+        log.msg.timestamp = i * 1000;
+        log.samples = 1;
+        send_and_check(frame, frame_encode_sensor(frame, sizeof(frame), seq, &log.msg), seq, &log);
+    }
+    // Codec batches: the SPI decoder must stay in step across frames
+    sensor_encoder_init(&enc, SENSOR_CODEC_DEFAULT_RESET, 1);
+    for (unsigned i = 0; i < TEST_FRAMES / 2; ++i, ++seq) {
+        size_t len = 0, taken;
+        for (unsigned k = 0; k < TEST_BATCH; ++k) {
+            unsigned t = i * TEST_BATCH + k;
+            log.msg.sensor_value = (int)(500 + t / 7 % 3);
+            log.msg.timestamp = t * 1000;
+            len += sensor_encode(&enc, &log.msg, 1, &taken, payload + len, FRAME_MAX_PAYLOAD - len);
+        }
+        len += sensor_encoder_flush(&enc, payload + len, FRAME_MAX_PAYLOAD - len);
+        log.samples = TEST_BATCH;
+        send_and_check(frame, frame_seal(frame, sizeof(frame), FRAME_TYPE_SENSOR_BATCH, seq, (uint16_t)len),
+                       seq, &log);
+    }
+    printf("[LinkTest] %u frames, %u UART / %u SPI / %u PCIe bytes: %s (%d failures)\n", (unsigned)seq,
+           (unsigned)g_uart.tx_bytes, (unsigned)g_spi.tx_bytes, (unsigned)g_pci.tx_bytes,
+           failures ? "FAILED" : "ok", failures);
+    fflush(stdout);
+    exit(failures ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int main(void) {
+    board_init();
+    uart_init();
+    spi_init(SPI_MODE_MASTER);
+    task_scheduler_init();
+    SIM_TASK_CREATE(vLinkTestTask, "LinkTest", 1024, NULL, TASK_PRIO_PCIE);
+    vTaskStartScheduler();
+    return EXIT_FAILURE;
+}
+
+// Hooks the kernel configuration asks for
+void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
+    printf("[FATAL] Stack overflow in task: %s\n", pcTaskName);
+    exit(EXIT_FAILURE);
+}
+
+void vApplicationMallocFailedHook(void) {
+    printf("[FATAL] Malloc failed!\n");
+    exit(EXIT_FAILURE);
+}
@@ -1,4 +1,5 @@
 #include "lru_cache.h"
+#include "sim_log.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -6,7 +7,7 @@ static lru_cache_t g_cache;
 
 void lru_cache_init(void) {
     memset(&g_cache, 0, sizeof(g_cache));
-    printf("[LRUCache] Initialized (size=%d).\n", LRU_CACHE_SIZE);
+    SIM_LOG("[LRUCache] Initialized (size=%d).\n", LRU_CACHE_SIZE);
 }
 
 void lru_cache_put(int key, int value) {
@@ -15,7 +16,7 @@ void lru_cache_put(int key, int value) {
         if (g_cache.entries[i].key == key) {
             g_cache.entries[i].value = value;
             g_cache.entries[i].last_used = ++g_cache.use_counter;
-            printf("[LRUCache] Updated key=%d value=%d\n", key, value);
+            SIM_LOG("[LRUCache] Updated key=%d value=%d\n", key, value);
             return;
         }
     }
@@ -25,7 +26,7 @@ void lru_cache_put(int key, int value) {
             g_cache.entries[i].key = key;
             g_cache.entries[i].value = value;
             g_cache.entries[i].last_used = ++g_cache.use_counter;
-            printf("[LRUCache] Inserted key=%d value=%d\n", key, value);
+            SIM_LOG("[LRUCache] Inserted key=%d value=%d\n", key, value);
             return;
         }
     }
@@ -41,7 +42,7 @@ void lru_cache_put(int key, int value) {
     g_cache.entries[lru_idx].key = key;
     g_cache.entries[lru_idx].value = value;
     g_cache.entries[lru_idx].last_used = ++g_cache.use_counter;
-    printf("[LRUCache] Replaced LRU idx=%d with key=%d value=%d\n", lru_idx, key, value);
+    SIM_LOG("[LRUCache] Replaced LRU idx=%d with key=%d value=%d\n", lru_idx, key, value);
 }
 
 int lru_cache_get(int key, int *found) {
@@ -49,18 +50,20 @@ int lru_cache_get(int key, int *found) {
         if (g_cache.entries[i].key == key && g_cache.entries[i].last_used != 0) {
             g_cache.entries[i].last_used = ++g_cache.use_counter;
             *found = 1;
-            printf("[LRUCache] Hit key=%d value=%d\n", key, g_cache.entries[i].value);
+            g_cache.hits++;
+            SIM_LOG("[LRUCache] Hit key=%d value=%d\n", key, g_cache.entries[i].value);
             return g_cache.entries[i].value;
         }
     }
     *found = 0;
-    printf("[LRUCache] Miss key=%d\n", key);
+    g_cache.misses++;
+    SIM_LOG("[LRUCache] Miss key=%d\n", key);
     return 0;
 }
 
 void lru_cache_clear(void) {
     memset(&g_cache, 0, sizeof(g_cache));
-    printf("[LRUCache] Cleared.\n");
+    SIM_LOG("[LRUCache] Cleared.\n");
 }
 
 size_t lru_cache_count(void) {
@@ -69,4 +72,18 @@ size_t lru_cache_count(void) {
         if (g_cache.entries[i].last_used != 0) ++count;
     }
     return count;
-}
\ No newline at end of file
+}
+
+void lru_cache_get_stats(uint32_t *hits, uint32_t *misses) {
+    *hits = g_cache.hits;
+    *misses = g_cache.misses;
+}
+
+void lru_cache_save(lru_cache_t *out) {
+    *out = g_cache;
+}
+
+void lru_cache_restore(const lru_cache_t *saved) {
+    g_cache = *saved;
+    SIM_LOG("[LRUCache] Restored %u entries.\n", (unsigned)lru_cache_count());
+}
@@ -15,6 +15,8 @@ typedef struct {
 typedef struct {
     lru_entry_t entries[LRU_CACHE_SIZE];
     uint32_t use_counter;
+    uint32_t hits;
+    uint32_t misses;
 } lru_cache_t;
 
 void lru_cache_init(void);
@@ -22,5 +24,9 @@ void lru_cache_put(int key, int value);
 int lru_cache_get(int key, int *found);
 void lru_cache_clear(void);
 size_t lru_cache_count(void);
+void lru_cache_get_stats(uint32_t *hits, uint32_t *misses);
+// Checkpoint support: contents, recency order and hit/miss counters
+void lru_cache_save(lru_cache_t *out);
+void lru_cache_restore(const lru_cache_t *saved);
 
 #endif // LRU_CACHE_H
\ No newline at end of file
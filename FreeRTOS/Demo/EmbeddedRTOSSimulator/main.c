@@ -10,16 +10,35 @@
 #include "pci.h"
 #include "task_scheduler.h"
 #include "lru_cache.h"
+#include "sim_config.h"
+#include "sim_time.h"
+#include "replay.h"
+#include "sim_alloc.h"
+#include "mem_profile.h"
+#include "queue_stats.h"
+#include "stats.h"
+#include "telemetry.h"
+#include "stats_shm.h"
+#include "metrics_log.h"
+#include "checkpoint.h"
+#include "fleet.h"
+#include "frame.h"
+#include "sensor_codec.h"
+#include "periodic.h"
+#include "protocol_link.h"
+#include "sched_analysis.h"
+#ifdef SIM_HEAP_POOL
+#include "heap_pool.h"
+#endif
 #include "FreeRTOSConfig.h"
-#include <errno.h>
-#include <unistd.h>
-#include <sys/socket.h>
-#include <netinet/in.h>
-#include <arpa/inet.h>
 
-#define REMOTE_STATS_IP   "192.168.1.100" // Set to your visualization server
-#define REMOTE_STATS_PORT 5005
 #define HEAP_WARN_THRESHOLD 2048
+
+// Start-up must not run out of heap with every optional task enabled
+#if configSUPPORT_DYNAMIC_ALLOCATION
+_Static_assert(SIM_HEAP_BUDGET + HEAP_WARN_THRESHOLD <= configTOTAL_HEAP_SIZE,
+               "configTOTAL_HEAP_SIZE is too small for the task set in task_scheduler.h");
+#endif
 #define STACK_WARN_THRESHOLD 128
 
 // Task prototypes
@@ -28,31 +47,87 @@ void vProtocolTask(void *pvParameters);
 void vLoggerTask(void *pvParameters);
 void vPCIeDemoTask(void *pvParameters);
 
-int main(void) {
+int main(int argc, char **argv) {
+    if (sim_config_parse(argc, argv) != 0) {
+        return EXIT_FAILURE;
+    }
+    // Fleet launcher: only the forked instances continue past this point
+    if (g_sim_config.fleet_size > 0 && fleet_launch(argv[0]) != 0) {
+        return EXIT_FAILURE;
+    }
     printf("EmbeddedRTOSSimulator starting...\n");
-    board_init();
-    uart_init();
-    spi_init(SPI_MODE_MASTER);
-    lru_cache_init();
+    srand(g_sim_config.seed);
+    sim_time_init(g_sim_config.time_scale, g_sim_config.run_for_ms, g_sim_config.host_sleep);
+    if (g_sim_config.mem_profile) {
+        mem_profile_enable(g_sim_config.mem_profile_path, g_sim_config.mem_margin);
+    }
+    if (g_sim_config.checkpoint_path) {
+        checkpoint_enable(g_sim_config.checkpoint_path);
+    }
+    if (g_sim_config.sched_analysis) {
+        sched_analysis_enable(g_sim_config.sched_analysis_path);
+    }
+    // Device bring-up, unless a snapshot replaces it (restored below, once the
+    // tasks that PCIe interrupts target exist)
+    if (!g_sim_config.restore_path) {
+        board_init();
+        uart_init();
+        spi_init(SPI_MODE_MASTER);
+        lru_cache_init();
+    }
     task_scheduler_init();
+    periodic_set_default_alarms(g_sim_config.jitter_alarm_pct, g_sim_config.response_alarm_pct);
     // PCIe Root Complex demo
-    xTaskCreate(vPCIeDemoTask, "PCIeRC", 512, (void*)PCI_TYPE_RC, TASK_PRIO_PCIE, NULL);
+    SIM_TASK_CREATE(vPCIeDemoTask, "PCIeRC", TASK_STACK_PCIE, (void*)PCI_TYPE_RC, TASK_PRIO_PCIE);
     // PCIe Endpoint demo
-    xTaskCreate(vPCIeDemoTask, "PCIeEP", 512, (void*)PCI_TYPE_EP, TASK_PRIO_PCIE, NULL);
+    SIM_TASK_CREATE(vPCIeDemoTask, "PCIeEP", TASK_STACK_PCIE, (void*)PCI_TYPE_EP, TASK_PRIO_PCIE);
     // Other tasks
-    xTaskCreate(vSensorTask, "Sensor", 256, NULL, TASK_PRIO_SENSOR, NULL);
-    xTaskCreate(vProtocolTask, "Protocol", 256, NULL, TASK_PRIO_PROTOCOL, NULL);
-    xTaskCreate(vLoggerTask, "Logger", 256, NULL, TASK_PRIO_LOGGER, NULL);
+    SIM_TASK_CREATE(vSensorTask, "Sensor", TASK_STACK_SENSOR, NULL, TASK_PRIO_SENSOR);
+    SIM_TASK_CREATE(vProtocolTask, "Protocol", TASK_STACK_PROTOCOL, NULL, TASK_PRIO_PROTOCOL);
+    SIM_TASK_CREATE(vLoggerTask, "Logger", TASK_STACK_LOGGER, NULL, TASK_PRIO_LOGGER);
+    // Run limit and Ctrl-C also when no task ever lets the CPU idle
+    SIM_TASK_CREATE(vSimTimeTask, "SimTime", TASK_STACK_SIM_TIME, NULL, TASK_PRIO_SIM_TIME);
+    // Recorded stimuli
+    if (g_sim_config.replay_path) {
+        if (replay_init(g_sim_config.replay_path, g_sim_config.replay_rate, g_sim_config.replay_loop) != 0) {
+            return EXIT_FAILURE;
+        }
+        SIM_TASK_CREATE(vReplayTask, "Replay", TASK_STACK_REPLAY, NULL, TASK_PRIO_REPLAY);
+    }
+    // Binary UDP telemetry; the simulation runs on if the socket cannot be set up
+    if (g_sim_config.telemetry &&
+        telemetry_init(g_sim_config.stats_host, g_sim_config.stats_port, g_sim_config.source_id,
+                       g_sim_config.stats_interval_ms, g_sim_config.stats_batch) == 0) {
+        SIM_TASK_CREATE(vTelemetryTask, "Telemetry", TASK_STACK_TELEMETRY, NULL, TASK_PRIO_TELEMETRY);
+    }
+    // Live stats for local readers (sim_stats_reader), or a fleet instance's slot
+    if (g_sim_config.shm_name) {
+        stats_shm_init(g_sim_config.shm_name, g_sim_config.shm_interval_ms);
+    }
+    if (stats_shm_enabled()) {
+        SIM_TASK_CREATE(vStatsShmTask, "StatsShm", TASK_STACK_STATS_SHM, NULL, TASK_PRIO_TELEMETRY);
+    }
+    // Long-run metrics for offline analysis (sim_metrics_convert)
+    if (g_sim_config.metrics_log) {
+        metrics_log_init(g_sim_config.metrics_log_path, g_sim_config.metrics_interval_ms);
+        SIM_TASK_CREATE(vMetricsLogTask, "MetricsLog", TASK_STACK_METRICS_LOG, NULL, TASK_PRIO_TELEMETRY);
+    }
+    // Warm start from a snapshot
+    if (g_sim_config.restore_path && checkpoint_restore(g_sim_config.restore_path) != 0) {
+        return EXIT_FAILURE;
+    }
     // Start scheduler
     vTaskStartScheduler();
-    // Should never reach here
-    for(;;);
-    return 0;
+    // Only reached if the scheduler could not start (no memory for the idle task)
+    printf("[FATAL] Scheduler failed to start\n");
+    return EXIT_FAILURE;
 }
 
 // --- Sensor Task: generates sensor data, uses LRU cache, sends to protocol ---
 void vSensorTask(void *pvParameters) {
+    struct periodic_task periodic;
     int key = 0;
+    periodic_init(&periodic, pdMS_TO_TICKS(TASK_PERIOD_SENSOR_MS), pdMS_TO_TICKS(TASK_DEADLINE_SENSOR_MS));
     for(;;) {
         int value = rand() % 1000;
         lru_cache_put(key, value);
@@ -60,62 +135,93 @@ void vSensorTask(void *pvParameters) {
         send_sensor_data(&msg, portMAX_DELAY);
         printf("[SensorTask] Sent sensor data: key=%d value=%d\n", key, value);
         key = (key + 1) % LRU_CACHE_SIZE;
-        vTaskDelay(pdMS_TO_TICKS(1000));
+        periodic_wait(&periodic);
     }
 }
 
-// --- Protocol Task: receives sensor data, handles UART/SPI/PCIe, logs to logger ---
+// --- Protocol Task: receives sensor data, frames it onto UART/SPI/PCIe, logs to logger ---
+// Codec state kept between frames; static to spare the task stack
+static struct sensor_encoder link_encoder;
+
 void vProtocolTask(void *pvParameters) {
     sensor_msg_t msg;
     protocol_log_t log;
+    uint8_t frame[FRAME_MAX_SIZE];
+    uint8_t *payload = frame + FRAME_HEADER_SIZE;
+    size_t payload_len = 0;
+    uint32_t batched = 0;
+    uint16_t seq = 0;
+    struct periodic_task periodic;
+
+    // One job per sensor sample: the sensor period is the shortest gap between them
+    periodic_init_sporadic(&periodic, pdMS_TO_TICKS(TASK_PERIOD_SENSOR_MS), pdMS_TO_TICKS(TASK_DEADLINE_PROTOCOL_MS));
+    protocol_link_init();
+    sensor_encoder_init(&link_encoder, g_sim_config.link_reset, g_sim_config.link_rle);
     for(;;) {
         if (recv_sensor_data(&msg, portMAX_DELAY) == pdTRUE) {
-            snprintf(log.log, sizeof(log.log), "Sensor value: %d at %u", msg.sensor_value, msg.timestamp);
-            send_protocol_log(&log, portMAX_DELAY);
-            // Simulate UART send/receive
-            uart_send(log.log);
-            char uart_buf[32];
-            uart_receive(uart_buf, sizeof(uart_buf));
-            // Simulate SPI transfer
-            char spi_rx[32];
-            spi_transfer(log.log, spi_rx, strlen(log.log)+1);
-            // Simulate PCIe AXI write
-            pci_axi_write(0x80000000, msg.sensor_value);
-            printf("[ProtocolTask] Processed sensor data, UART/SPI/PCIe actions done.\n");
+            size_t n = 0;
+            periodic_job_begin(&periodic);
+            stats_record_latency(xTaskGetTickCount() - msg.timestamp);
+            if (g_sim_config.link_batch <= 1) {
+                n = frame_encode_sensor(frame, sizeof(frame), seq, &msg);
+                batched = 1;
+            } else {
+                // Codec records go straight into the frame payload. The frame is sent when
+                // the batch is complete or the worst-case next sample might not fit.
+                size_t taken;
+                payload_len += sensor_encode(&link_encoder, &msg, 1, &taken,
+                                             payload + payload_len, FRAME_MAX_PAYLOAD - payload_len);
+                if (++batched >= g_sim_config.link_batch ||
+                    FRAME_MAX_PAYLOAD - payload_len < SENSOR_CODEC_MAX_SAMPLE_BYTES) {
+                    payload_len += sensor_encoder_flush(&link_encoder, payload + payload_len,
+                                                        FRAME_MAX_PAYLOAD - payload_len);
+                    n = frame_seal(frame, sizeof(frame), FRAME_TYPE_SENSOR_BATCH, seq, (uint16_t)payload_len);
+                }
+            }
+            if (n) {
+                log.msg = msg;
+                log.samples = (uint8_t)batched;
+                protocol_link_send(frame, n, seq++, &log);
+                send_protocol_log(&log, portMAX_DELAY);
+                payload_len = 0;
+                batched = 0;
+                printf("[ProtocolTask] Processed sensor data, UART/SPI/PCIe actions done.\n");
+            }
+            periodic_job_end(&periodic);
+            if (n) {
+                // Link time: once per frame, so batching raises the sample rate the links carry.
+                // The task is suspended, not running, so it is not part of the job.
+                vTaskDelay(pdMS_TO_TICKS(500));
+            }
         }
-        vTaskDelay(pdMS_TO_TICKS(500));
     }
 }
 
 // FreeRTOS hook implementations
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName) {
     printf("[FATAL] Stack overflow in task: %s\n", pcTaskName);
-    fflush(stdout);
-    for(;;); // Halt
+    sim_time_fatal(g_sim_config.fatal_park);
 }
 
 void vApplicationMallocFailedHook(void) {
     printf("[FATAL] Malloc failed!\n");
-    fflush(stdout);
-    for(;;); // Halt
+    sim_time_fatal(g_sim_config.fatal_park);
 }
 
 // --- Logger Task: receives logs, prints, and shows LRU cache state ---
 void vLoggerTask(void *pvParameters) {
+    struct periodic_task periodic;
     protocol_log_t log;
     TickType_t lastStats = xTaskGetTickCount();
-    int udp_sock = -1;
-    struct sockaddr_in remote_addr;
-    // Setup UDP socket for remote export
-    udp_sock = socket(AF_INET, SOCK_DGRAM, 0);
-    memset(&remote_addr, 0, sizeof(remote_addr));
-    remote_addr.sin_family = AF_INET;
-    remote_addr.sin_port = htons(REMOTE_STATS_PORT);
-    inet_pton(AF_INET, REMOTE_STATS_IP, &remote_addr.sin_addr);
 
+    periodic_init(&periodic, pdMS_TO_TICKS(TASK_PERIOD_LOGGER_MS), pdMS_TO_TICKS(TASK_DEADLINE_LOGGER_MS));
     for(;;) {
-        if (recv_protocol_log(&log, portMAX_DELAY) == pdTRUE) {
-            printf("[LoggerTask] Log: %s\n", log.log);
+        // Everything the protocol task queued since the last release
+        while (recv_protocol_log(&log, 0) == pdTRUE) {
+            printf("[LoggerTask] Log: Sensor value: %d at %u (frame %u, %u samples in %u bytes, loopback %s, %u peer frames, %u CRC errors, %u link errors)\n",
+                   log.msg.sensor_value, (unsigned)log.msg.timestamp, log.seq, log.samples, log.frame_len,
+                   log.loopback_ok ? "ok" : "FAILED", (unsigned)log.peer_frames, (unsigned)log.crc_errors,
+                   (unsigned)log.link_errors);
             // Show LRU cache state
             printf("[LoggerTask] LRU cache entries: ");
             for (int i = 0; i < LRU_CACHE_SIZE; ++i) {
@@ -129,19 +235,30 @@ void vLoggerTask(void *pvParameters) {
         if ((xTaskGetTickCount() - lastStats) > pdMS_TO_TICKS(10000)) {
             char stats[1024];
             vTaskList(stats);
+#if configSUPPORT_DYNAMIC_ALLOCATION
             UBaseType_t freeHeap = xPortGetFreeHeapSize();
-            UBaseType_t q1 = uxQueueMessagesWaiting(qSensorToProtocol);
-            UBaseType_t q2 = uxQueueMessagesWaiting(qProtocolToLogger);
+#else
+            UBaseType_t freeHeap = 0; // Static allocation build: no FreeRTOS heap
+#endif
             UBaseType_t semCount = uxSemaphoreGetCount(semPCIeEvent);
             EventBits_t evBits = xEventGroupGetBits(egSystemEvents);
-            TaskStatus_t taskStatus[10];
-            UBaseType_t numTasks = uxTaskGetSystemState(taskStatus, 10, NULL);
+            static TaskStatus_t taskStatus[SIM_MAX_TASKS];
+            UBaseType_t numTasks = uxTaskGetSystemState(taskStatus, SIM_MAX_TASKS, NULL);
+            if (numTasks == 0) {
+                printf("[WARN] %lu tasks exceed SIM_MAX_TASKS (%u), stack stats skipped\n",
+                       (unsigned long)uxTaskGetNumberOfTasks(), (unsigned)SIM_MAX_TASKS);
+            }
             FILE *f = fopen("sim_stats.log", "a");
             if (!f) f = stdout;
             fprintf(f, "\n[LoggerTask] FreeRTOS Task Stats:\n%s\n", stats);
-            fprintf(f, "[LoggerTask] Free heap: %u bytes\n", (unsigned)freeHeap);
-            fprintf(f, "[LoggerTask] qSensorToProtocol: %lu messages waiting\n", (unsigned long)q1);
-            fprintf(f, "[LoggerTask] qProtocolToLogger: %lu messages waiting\n", (unsigned long)q2);
+            if (configSUPPORT_DYNAMIC_ALLOCATION) {
+                fprintf(f, "[LoggerTask] Free heap: %u bytes\n", (unsigned)freeHeap);
+            }
+#ifdef SIM_HEAP_POOL
+            heap_pool_print_stats(f);
+#endif
+            queue_stats_print(f);
+            periodic_print(f);
             fprintf(f, "[LoggerTask] semPCIeEvent count: %lu\n", (unsigned long)semCount);
             fprintf(f, "[LoggerTask] egSystemEvents bits: 0x%08lx\n", (unsigned long)evBits);
             fprintf(f, "[LoggerTask] Per-task stack high water marks:\n");
@@ -153,39 +270,37 @@ void vLoggerTask(void *pvParameters) {
                     printf("[WARN] Stack low for task %s: %lu bytes min free\n", taskStatus[i].pcTaskName, (unsigned long)taskStatus[i].usStackHighWaterMark * sizeof(StackType_t));
                 }
             }
-            if (freeHeap < HEAP_WARN_THRESHOLD) {
+            if (configSUPPORT_DYNAMIC_ALLOCATION && freeHeap < HEAP_WARN_THRESHOLD) {
                 printf("[WARN] FreeRTOS heap low: %u bytes left!\n", (unsigned)freeHeap);
             }
             if (f != stdout) fclose(f);
-            // --- Remote export via UDP ---
-            char udp_buf[1024];
-            int udp_len = snprintf(udp_buf, sizeof(udp_buf),
-                "HEAP:%u Q1:%lu Q2:%lu SEM:%lu EV:0x%08lx",
-                (unsigned)freeHeap, (unsigned long)q1, (unsigned long)q2, (unsigned long)semCount, (unsigned long)evBits);
-            sendto(udp_sock, udp_buf, udp_len, 0, (struct sockaddr*)&remote_addr, sizeof(remote_addr));
-            // --- For visualization tools: consider exporting as CSV or JSON ---
-            // Example CSV: fprintf(f, "%%u,%%lu,%%lu,%%lu,0x%%08lx\n", ...);
-            // Example JSON: fprintf(f, "{\"heap\":%%u,...}\n", ...);
+            // Remote export is binary telemetry from vTelemetryTask (telemetry.c)
+            // CSV/JSON for visualization tools: --metrics-log + sim_metrics_convert
             lastStats = xTaskGetTickCount();
         }
-        vTaskDelay(pdMS_TO_TICKS(2000));
+        periodic_wait(&periodic);
     }
 }
 
 // --- PCIe Demo Task: initializes as RC or EP, simulates interrupts ---
 void vPCIeDemoTask(void *pvParameters) {
     pci_dev_type_t type = (pci_dev_type_t)pvParameters;
-    if (type == PCI_TYPE_RC) {
+    struct periodic_task periodic;
+    if (g_sim_config.restore_path) {
+        printf("\n[PCIe Demo] %s: link state restored from snapshot, bring-up skipped\n", type == PCI_TYPE_RC ? "RC" : "EP");
+    } else if (type == PCI_TYPE_RC) {
         printf("\n[PCIe Demo] Initializing as Root Complex (RC)...\n");
         pci_init(PCI_TYPE_RC, PCI_GEN7, PCI_LANES_X16);
     } else {
         printf("\n[PCIe Demo] Initializing as Endpoint (EP)...\n");
         pci_init(PCI_TYPE_EP, PCI_GEN7, PCI_LANES_X8);
     }
+    // Bring-up is not part of the periodic work: the first release is after it
+    periodic_init(&periodic, pdMS_TO_TICKS(TASK_PERIOD_PCIE_MS), pdMS_TO_TICKS(TASK_DEADLINE_PCIE_MS));
     for(;;) {
         // Simulate PCIe events, e.g., MSI/MSIX/INTC
         pci_simulate_event(PCI_INT_MSI, 0);
         signal_pcie_event();
-        vTaskDelay(pdMS_TO_TICKS(5000));
+        periodic_wait(&periodic);
     }
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "mem_profile.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "task_scheduler.h"
+#include "queue_stats.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const char *profile_path = NULL;
+static uint32_t profile_margin = MEM_PROFILE_DEFAULT_MARGIN;
+
+static uint32_t with_margin(uint32_t used, uint32_t margin_pct) {
+    return (uint32_t)(((uint64_t)used * (100 + margin_pct) + 99) / 100);
+}
+
+static uint32_t round_up(uint32_t v, uint32_t to) {
+    return (v + to - 1) / to * to;
+}
+
+static uint32_t declared_stack_depth(const TaskStatus_t *st) {
+    const struct task_info *info = task_scheduler_find_task(st->xHandle);
+    if (info) return info->stack_depth;
+    // The kernel creates the idle task itself, always with the minimal stack
+    if (strcmp(st->pcTaskName, "IDLE") == 0) return configMINIMAL_STACK_SIZE;
+    return 0;
+}
+
+static size_t write_stacks(FILE *f, uint32_t margin_pct) {
+    static TaskStatus_t status[SIM_MAX_TASKS];
+    UBaseType_t total = uxTaskGetNumberOfTasks();
+    UBaseType_t n;
+    size_t saved = 0;
+
+    if (total > SIM_MAX_TASKS) {
+        fprintf(f, "WARNING: %lu tasks exist but only %u fit the snapshot; raise SIM_MAX_TASKS\n",
+                (unsigned long)total, (unsigned)SIM_MAX_TASKS);
+        return 0;
+    }
+    n = uxTaskGetSystemState(status, SIM_MAX_TASKS, NULL);
+    fprintf(f, "Task stacks (words of %u bytes):\n", (unsigned)sizeof(StackType_t));
+    fprintf(f, "  %-16s %9s %9s %11s %13s\n", "task", "declared", "peak used", "recommended", "saved (bytes)");
+    for (UBaseType_t i = 0; i < n; ++i) {
+        uint32_t depth = declared_stack_depth(&status[i]);
+        uint32_t hwm = status[i].usStackHighWaterMark;
+        uint32_t used, rec;
+        if (depth == 0) {
+            fprintf(f, "  %-16s %9s %9s %11s %13s  (%lu words never used, size unknown)\n",
+                    status[i].pcTaskName, "?", "?", "-", "-", (unsigned long)hwm);
+            continue;
+        }
+        used = depth > hwm ? depth - hwm : 0;
+        if (hwm == 0) {
+            // The whole stack was touched: it may already have overflowed
+            rec = round_up(with_margin(depth, margin_pct), MEM_PROFILE_STACK_ROUND);
+            fprintf(f, "  %-16s %9u %9u %11u %13s  OVERFLOW RISK, grow\n",
+                    status[i].pcTaskName, (unsigned)depth, (unsigned)used, (unsigned)rec, "-");
+            continue;
+        }
+        rec = round_up(with_margin(used, margin_pct), MEM_PROFILE_STACK_ROUND);
+        if (rec < MEM_PROFILE_STACK_FLOOR) rec = MEM_PROFILE_STACK_FLOOR;
+        if (rec >= depth) {
+            fprintf(f, "  %-16s %9u %9u %11u %13s  keep\n",
+                    status[i].pcTaskName, (unsigned)depth, (unsigned)used, (unsigned)depth, "0");
+            continue;
+        }
+        saved += (size_t)(depth - rec) * sizeof(StackType_t);
+        fprintf(f, "  %-16s %9u %9u %11u %13lu\n", status[i].pcTaskName, (unsigned)depth, (unsigned)used,
+                (unsigned)rec, (unsigned long)(depth - rec) * sizeof(StackType_t));
+    }
+    return saved;
+}
+
+static size_t write_queues(FILE *f, uint32_t margin_pct) {
+    struct queue_stats_entry q[QUEUE_STATS_MAX];
+    size_t n = queue_stats_snapshot(q, QUEUE_STATS_MAX);
+    size_t saved = 0;
+
+    if (n > QUEUE_STATS_MAX) n = QUEUE_STATS_MAX;
+    fprintf(f, "Queues (items):\n");
+    fprintf(f, "  %-18s %6s %6s %6s %11s %13s\n", "queue", "item", "length", "peak", "recommended", "saved (bytes)");
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t rec;
+        if (q[i].peak >= q[i].length) {
+            // Senders may have blocked or failed: the peak hides the real demand
+            fprintf(f, "  %-18s %6lu %6lu %6lu %11lu %13s  FULL at peak, keep or grow\n",
+                    q[i].name, (unsigned long)q[i].item_size, (unsigned long)q[i].length,
+                    (unsigned long)q[i].peak, (unsigned long)q[i].length, "-");
+            continue;
+        }
+        rec = with_margin((uint32_t)q[i].peak, margin_pct);
+        if (rec < 1) rec = 1;
+        if (rec >= q[i].length) rec = (uint32_t)q[i].length;
+        saved += (size_t)(q[i].length - rec) * q[i].item_size;
+        fprintf(f, "  %-18s %6lu %6lu %6lu %11u %13lu\n", q[i].name, (unsigned long)q[i].item_size,
+                (unsigned long)q[i].length, (unsigned long)q[i].peak, (unsigned)rec,
+                (unsigned long)(q[i].length - rec) * q[i].item_size);
+    }
+    return saved;
+}
+
+void mem_profile_write(FILE *f, uint32_t margin_pct) {
+    size_t saved;
+    fprintf(f, "EmbeddedRTOSSimulator memory profile after %lu ticks (margin %u%%)\n",
+            (unsigned long)xTaskGetTickCount(), (unsigned)margin_pct);
+    saved = write_stacks(f, margin_pct);
+    saved += write_queues(f, margin_pct);
+#if configSUPPORT_DYNAMIC_ALLOCATION
+    {
+        size_t peak = configTOTAL_HEAP_SIZE - xPortGetMinimumEverFreeHeapSize();
+        // Smaller stacks and queues come out of the heap, so it shrinks by the same amount
+        size_t need = peak > saved ? peak - saved : 0;
+        size_t rec = round_up(with_margin((uint32_t)need, margin_pct), 1024);
+        fprintf(f, "Heap: configTOTAL_HEAP_SIZE %lu, peak used %lu, recommended %lu after the changes above\n",
+                (unsigned long)configTOTAL_HEAP_SIZE, (unsigned long)peak, (unsigned long)rec);
+        saved = rec < configTOTAL_HEAP_SIZE ? configTOTAL_HEAP_SIZE - rec : 0;
+    }
+#endif
+    fprintf(f, "Estimated RAM saved per instance: %lu bytes\n", (unsigned long)saved);
+}
+
+static void mem_profile_at_exit(void) {
+    FILE *f = fopen(profile_path, "w");
+    if (!f) {
+        printf("[MemProfile] Cannot write %s\n", profile_path);
+        return;
+    }
+    mem_profile_write(f, profile_margin);
+    fclose(f);
+    printf("[MemProfile] Report written to %s\n", profile_path);
+}
+
+void mem_profile_enable(const char *path, uint32_t margin_pct) {
+    profile_path = path ? path : MEM_PROFILE_DEFAULT_PATH;
+    profile_margin = margin_pct;
+    atexit(mem_profile_at_exit);
+    printf("[MemProfile] Profiling stacks and queues, report at exit: %s\n", profile_path);
+}
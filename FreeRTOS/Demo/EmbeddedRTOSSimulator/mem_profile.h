@@ -0,0 +1,19 @@
+#ifndef MEM_PROFILE_H
+#define MEM_PROFILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define MEM_PROFILE_DEFAULT_PATH   "mem_profile.txt"
+#define MEM_PROFILE_DEFAULT_MARGIN 25   // Percent added on top of the observed peak
+#define MEM_PROFILE_STACK_ROUND    16   // Recommended stacks are rounded up to this many words
+#define MEM_PROFILE_STACK_FLOOR    64   // Never recommend a stack below this many words
+
+// Memory footprint profiler (--mem-profile). Stack high-water marks and queue
+// peaks are tracked by the kernel and queue_stats for the whole run; at exit
+// the report compares them with the declared sizes and recommends minimal
+// sizes plus margin, with the RAM each change would save.
+void mem_profile_enable(const char *path, uint32_t margin_pct);
+void mem_profile_write(FILE *f, uint32_t margin_pct);
+
+#endif // MEM_PROFILE_H
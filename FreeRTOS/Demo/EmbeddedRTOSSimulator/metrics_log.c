@@ -0,0 +1,248 @@
+#include "metrics_log.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Where a column's value comes from in struct sim_stats
+typedef enum {
+    COL_TICK = 0,
+    COL_FREE_HEAP,
+    COL_MIN_FREE_HEAP,
+    COL_CACHE_HITS,
+    COL_CACHE_MISSES,
+    COL_UART_TX,
+    COL_UART_RX,
+    COL_SPI_TX,
+    COL_SPI_RX,
+    COL_PCIE_LEGACY,
+    COL_PCIE_MSI,
+    COL_PCIE_MSIX,
+    COL_PCIE_INTC,
+    COL_LATENCY_COUNT,
+    COL_LATENCY_SUM,
+    COL_LATENCY_MAX,
+    COL_TASK_RUN_TIME,      // Per task, matched by id
+    COL_TASK_STACK_FREE,
+    COL_QUEUE_WAITING,      // Per queue, by index
+    COL_QUEUE_SENDS,
+    COL_QUEUE_RECEIVES,
+    COL_QUEUE_SEND_FAILURES,
+    COL_QUEUE_RECEIVE_FAILURES,
+} column_kind_t;
+
+struct column {
+    column_kind_t kind;
+    uint32_t id;            // Task id or queue index
+};
+
+static const char *const scalar_names[] = {
+    "tick", "free_heap", "min_free_heap", "cache_hits", "cache_misses",
+    "uart_tx_bytes", "uart_rx_bytes", "spi_tx_bytes", "spi_rx_bytes",
+    "pcie_legacy", "pcie_msi", "pcie_msix", "pcie_intc",
+    "latency_count", "latency_sum", "latency_max",
+};
+
+static const char *log_path = METRICS_LOG_DEFAULT_PATH;
+static uint32_t log_interval_ms = METRICS_LOG_DEFAULT_INTERVAL_MS;
+static int fd = -1;
+static struct column columns[METRICS_LOG_MAX_COLUMNS];
+static struct metrics_log_column column_names[METRICS_LOG_MAX_COLUMNS];
+static uint32_t num_columns = 0;
+static uint32_t block_bytes = 0;
+static uint8_t *block = NULL;   // Block header + column arrays, written as one unit
+static uint32_t block_count = 0;
+
+static uint32_t *block_column(uint32_t c) {
+    return (uint32_t *)(block + sizeof(struct metrics_log_block_header)) + (size_t)c * METRICS_LOG_BLOCK_ROWS;
+}
+
+static void add_column(column_kind_t kind, uint32_t id, const char *prefix, const char *name) {
+    if (num_columns >= METRICS_LOG_MAX_COLUMNS) return;
+    columns[num_columns].kind = kind;
+    columns[num_columns].id = id;
+    if (prefix) {
+        snprintf(column_names[num_columns].name, METRICS_LOG_NAME_LEN, "%s.%s", prefix, name);
+    } else {
+        snprintf(column_names[num_columns].name, METRICS_LOG_NAME_LEN, "%s", name);
+    }
+    num_columns++;
+}
+
+static void build_schema(const struct sim_stats *st) {
+    for (int k = COL_TICK; k <= COL_LATENCY_MAX; ++k) {
+        add_column((column_kind_t)k, 0, NULL, scalar_names[k]);
+    }
+    for (uint32_t i = 0; i < st->num_tasks; ++i) {
+        add_column(COL_TASK_RUN_TIME, st->tasks[i].id, st->tasks[i].name, "run_time");
+        add_column(COL_TASK_STACK_FREE, st->tasks[i].id, st->tasks[i].name, "stack_free");
+    }
+    for (uint32_t i = 0; i < st->num_queues; ++i) {
+        add_column(COL_QUEUE_WAITING, i, st->queues[i].name, "waiting");
+        add_column(COL_QUEUE_SENDS, i, st->queues[i].name, "sends");
+        add_column(COL_QUEUE_RECEIVES, i, st->queues[i].name, "receives");
+        add_column(COL_QUEUE_SEND_FAILURES, i, st->queues[i].name, "send_failures");
+        add_column(COL_QUEUE_RECEIVE_FAILURES, i, st->queues[i].name, "receive_failures");
+    }
+}
+
+static const struct stats_task *find_task(const struct sim_stats *st, uint32_t id) {
+    for (uint32_t i = 0; i < st->num_tasks; ++i) {
+        if (st->tasks[i].id == id) return &st->tasks[i];
+    }
+    return NULL;
+}
+
+static uint32_t column_value(const struct column *c, const struct sim_stats *st) {
+    const struct stats_task *t;
+    const struct queue_stats_entry *q = c->id < st->num_queues ? &st->queues[c->id] : NULL;
+    switch (c->kind) {
+        case COL_TICK:              return st->tick;
+        case COL_FREE_HEAP:         return st->free_heap;
+        case COL_MIN_FREE_HEAP:     return st->min_free_heap;
+        case COL_CACHE_HITS:        return st->cache_hits;
+        case COL_CACHE_MISSES:      return st->cache_misses;
+        case COL_UART_TX:           return st->uart_tx_bytes;
+        case COL_UART_RX:           return st->uart_rx_bytes;
+        case COL_SPI_TX:            return st->spi_tx_bytes;
+        case COL_SPI_RX:            return st->spi_rx_bytes;
+        case COL_PCIE_LEGACY:
+        case COL_PCIE_MSI:
+        case COL_PCIE_MSIX:
+        case COL_PCIE_INTC:         return st->pcie_irqs[c->kind - COL_PCIE_LEGACY];
+        case COL_LATENCY_COUNT:     return st->latency_count;
+        case COL_LATENCY_SUM:       return st->latency_sum;
+        case COL_LATENCY_MAX:       return st->latency_max;
+        case COL_TASK_RUN_TIME:     return (t = find_task(st, c->id)) ? t->run_time : 0;
+        case COL_TASK_STACK_FREE:   return (t = find_task(st, c->id)) ? t->stack_free : 0;
+        case COL_QUEUE_WAITING:     return q ? (uint32_t)q->waiting : 0;
+        case COL_QUEUE_SENDS:       return q ? q->sends : 0;
+        case COL_QUEUE_RECEIVES:    return q ? q->receives : 0;
+        case COL_QUEUE_SEND_FAILURES:    return q ? q->send_failures : 0;
+        case COL_QUEUE_RECEIVE_FAILURES: return q ? q->receive_failures : 0;
+    }
+    return 0;
+}
+
+static int write_all(const void *buf, size_t len) {
+    const uint8_t *p = buf;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int metrics_log_open(const struct sim_stats *st) {
+    struct metrics_log_header hdr;
+
+    build_schema(st);
+    block_bytes = (uint32_t)(sizeof(struct metrics_log_block_header) + (size_t)num_columns * METRICS_LOG_BLOCK_ROWS * sizeof(uint32_t));
+    block = calloc(1, block_bytes);
+    if (!block) {
+        printf("[MetricsLog] Cannot allocate a %u byte block\n", (unsigned)block_bytes);
+        return -1;
+    }
+    fd = open(log_path, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (fd < 0) {
+        printf("[MetricsLog] Cannot open %s: %s\n", log_path, strerror(errno));
+        return -1;
+    }
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, METRICS_LOG_MAGIC, sizeof(METRICS_LOG_MAGIC));
+    hdr.version = METRICS_LOG_VERSION;
+    hdr.byte_order = METRICS_LOG_BYTE_ORDER;
+    hdr.header_size = (uint32_t)(sizeof(hdr) + num_columns * sizeof(struct metrics_log_column));
+    hdr.num_columns = num_columns;
+    hdr.block_rows = METRICS_LOG_BLOCK_ROWS;
+    hdr.block_bytes = block_bytes;
+    hdr.tick_rate_hz = configTICK_RATE_HZ;
+    hdr.interval_ms = log_interval_ms;
+    if (write_all(&hdr, sizeof(hdr)) != 0 ||
+        write_all(column_names, num_columns * sizeof(struct metrics_log_column)) != 0) {
+        printf("[MetricsLog] Cannot write header to %s: %s\n", log_path, strerror(errno));
+        close(fd);
+        fd = -1;
+        return -1;
+    }
+    printf("[MetricsLog] %s: %u columns, %u rows per %u byte block\n",
+           log_path, (unsigned)num_columns, (unsigned)METRICS_LOG_BLOCK_ROWS, (unsigned)block_bytes);
+    return 0;
+}
+
+static void metrics_log_flush(void) {
+    struct metrics_log_block_header *bh = (struct metrics_log_block_header *)block;
+    if (fd < 0 || bh->rows == 0) return;
+    bh->magic = METRICS_LOG_BLOCK_MAGIC;
+    if (write_all(block, block_bytes) != 0) {
+        printf("[MetricsLog] Write to %s failed: %s, logging stopped\n", log_path, strerror(errno));
+        close(fd);
+        fd = -1;
+        return;
+    }
+    block_count++;
+    bh->rows = 0;
+}
+
+static void metrics_log_at_exit(void) {
+    // Rows are committed only after all their columns are stored, so a
+    // sample interrupted by exit() is simply not counted
+    metrics_log_flush();
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+        printf("[MetricsLog] %u blocks written to %s\n", (unsigned)block_count, log_path);
+    }
+}
+
+void metrics_log_init(const char *path, uint32_t interval_ms) {
+    log_path = path ? path : METRICS_LOG_DEFAULT_PATH;
+    log_interval_ms = interval_ms;
+    atexit(metrics_log_at_exit);
+}
+
+int metrics_log_append(const struct sim_stats *st) {
+    struct metrics_log_block_header *bh;
+    uint32_t row;
+    if (block == NULL && metrics_log_open(st) != 0) return -1;
+    if (fd < 0) return -1;
+    bh = (struct metrics_log_block_header *)block;
+    row = bh->rows;
+    for (uint32_t c = 0; c < num_columns; ++c) {
+        block_column(c)[row] = column_value(&columns[c], st);
+    }
+    if (row == 0) bh->first_tick = st->tick;
+    bh->last_tick = st->tick;
+    bh->rows = row + 1;
+    if (bh->rows == METRICS_LOG_BLOCK_ROWS) {
+        metrics_log_flush();
+    }
+    return 0;
+}
+
+// --- Metrics Log Task: appends one row per interval ---
+void vMetricsLogTask(void *pvParameters) {
+    static struct sim_stats st;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(log_interval_ms);
+
+    if (period == 0) period = 1;
+    for (;;) {
+        vTaskDelayUntil(&last_wake, period);
+        stats_collect(&st);
+        if (metrics_log_append(&st) != 0) {
+            break;
+        }
+    }
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
@@ -0,0 +1,59 @@
+#ifndef METRICS_LOG_H
+#define METRICS_LOG_H
+
+#include <stdint.h>
+
+// Append-only columnar metrics file (--metrics-log). Layout, in the writer's
+// byte order (checked through byte_order):
+//
+//   struct metrics_log_header
+//   struct metrics_log_column[num_columns]       column 0 is always "tick"
+//   block 0, block 1, ...                        every block is block_bytes long
+//
+// A block is a struct metrics_log_block_header followed by num_columns
+// arrays of block_rows uint32_t values (column-major); only the first `rows`
+// entries of each array are valid. Fixed-size blocks make block N seekable
+// at header_size + N * block_bytes. Values are the cumulative counters of
+// stats_collect() and wrap at 2^32. Only complete blocks are written during
+// the run; the last, partial block is written at exit.
+#define METRICS_LOG_MAGIC        "SIMMETR"
+#define METRICS_LOG_VERSION      1
+#define METRICS_LOG_BYTE_ORDER   0x01020304u
+#define METRICS_LOG_BLOCK_MAGIC  0x4B4C4253u  // "SBLK"
+#define METRICS_LOG_NAME_LEN     32
+#define METRICS_LOG_BLOCK_ROWS   256
+#define METRICS_LOG_MAX_COLUMNS  128
+#define METRICS_LOG_DEFAULT_PATH "sim_metrics.bin"
+#define METRICS_LOG_DEFAULT_INTERVAL_MS 1000
+
+struct metrics_log_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t header_size;       // Offset of block 0
+    uint32_t num_columns;
+    uint32_t block_rows;
+    uint32_t block_bytes;
+    uint32_t tick_rate_hz;
+    uint32_t interval_ms;       // Sampling period
+};
+
+struct metrics_log_column {
+    char name[METRICS_LOG_NAME_LEN];
+};
+
+struct metrics_log_block_header {
+    uint32_t magic;
+    uint32_t rows;
+    uint32_t first_tick;
+    uint32_t last_tick;
+};
+
+// Simulator side. The column set is fixed from the first sample, when all
+// tasks and queues exist; vMetricsLogTask samples every interval.
+struct sim_stats;
+void metrics_log_init(const char *path, uint32_t interval_ms);
+int metrics_log_append(const struct sim_stats *st);
+void vMetricsLogTask(void *pvParameters);
+
+#endif // METRICS_LOG_H
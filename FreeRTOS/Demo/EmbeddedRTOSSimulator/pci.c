@@ -1,5 +1,8 @@
 #include "pci.h"
 #include "board.h"
+#include "sim_alloc.h"
+#include "queue_stats.h"
+#include "sim_log.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -7,13 +10,23 @@ struct pci_state g_pci;
 
 // --- PCIe Initialization Steps ---
 
+static QueueHandle_t pci_event_queue_get(void) {
+    if (g_pci.event_queue == NULL) {
+        g_pci.event_queue = SIM_QUEUE_CREATE(PCI_EVENT_QUEUE_LEN, sizeof(pci_int_type_t));
+        queue_stats_register(g_pci.event_queue, "pci_event_queue", PCI_EVENT_QUEUE_LEN, sizeof(pci_int_type_t));
+    }
+    return g_pci.event_queue;
+}
+
 void pci_init(pci_dev_type_t type, pci_link_speed_t speed, pci_lane_width_t width) {
+    // RC and EP bring-up share g_pci: keep the event queue across re-init
+    QueueHandle_t event_queue = pci_event_queue_get();
     memset(&g_pci, 0, sizeof(g_pci));
-    g_pci.event_queue = xQueueCreate(8, sizeof(pci_int_type_t));
+    g_pci.event_queue = event_queue;
     g_pci.dev_type = type;
     g_pci.link_speed = speed;
     g_pci.lane_width = width;
-    printf("[PCIe] Init: type=%s, speed=Gen%d, lanes=x%d\n", type == PCI_TYPE_RC ? "RC" : "EP", speed, width);
+    SIM_LOG("[PCIe] Init: type=%s, speed=Gen%d, lanes=x%d\n", type == PCI_TYPE_RC ? "RC" : "EP", speed, width);
     pci_clock_pll_init();
     pci_perst_deassert();
     pci_firmware_load();
@@ -28,27 +41,35 @@ void pci_init(pci_dev_type_t type, pci_link_speed_t speed, pci_lane_width_t widt
     pci_linkup();
 }
 
+void pci_restore(const struct pci_state *saved) {
+    QueueHandle_t event_queue = pci_event_queue_get();
+    g_pci = *saved;
+    g_pci.event_queue = event_queue;
+    SIM_LOG("[PCIe] Restored: type=%s, speed=Gen%d, lanes=x%d, link %s\n", g_pci.dev_type == PCI_TYPE_RC ? "RC" : "EP",
+            g_pci.link_speed, g_pci.lane_width, g_pci.link_up ? "up" : "down");
+}
+
 void pci_clock_pll_init(void) {
     g_pci.pll_locked = 1;
-    printf("[PCIe] Clock/PLL initialized and locked.\n");
+    SIM_LOG("[PCIe] Clock/PLL initialized and locked.\n");
     board_reg_write(BOARD_REG_PCI, 0x10);
 }
 
 void pci_perst_deassert(void) {
     g_pci.perst_deasserted = 1;
-    printf("[PCIe] PERST# deasserted.\n");
+    SIM_LOG("[PCIe] PERST# deasserted.\n");
     board_reg_write(BOARD_REG_PCI, 0x11);
 }
 
 void pci_firmware_load(void) {
     g_pci.fw_loaded = 1;
-    printf("[PCIe] Firmware loaded (if soft IP/FPGA).\n");
+    SIM_LOG("[PCIe] Firmware loaded (if soft IP/FPGA).\n");
     board_reg_write(BOARD_REG_PCI, 0x12);
 }
 
 void pci_cr_para_axi_write(void) {
     g_pci.cr_para_written = 1;
-    printf("[PCIe] CR_PARA AXI config written.\n");
+    SIM_LOG("[PCIe] CR_PARA AXI config written.\n");
     board_reg_write(BOARD_REG_PCI, 0x13);
 }
 
@@ -61,7 +82,7 @@ void pci_header_init(void) {
     g_pci.config_space[0x34/4] = 0x40;      // Capabilities pointer
     g_pci.config_space[0x10/4] = 0x00000000; // BAR0
     g_pci.config_space[0x14/4] = 0x00000000; // BAR1
-    printf("[PCIe] Header/config space initialized.\n");
+    SIM_LOG("[PCIe] Header/config space initialized.\n");
     // Add PCIe and MSI capabilities
     uint8_t pcie_cap[14] = {0};
     pcie_cap[0] = 0x10; // PCIe Cap ID
@@ -74,21 +95,21 @@ void pci_header_init(void) {
 void pci_set_link_speed_and_width(pci_link_speed_t speed, pci_lane_width_t width) {
     g_pci.link_speed = speed;
     g_pci.lane_width = width;
-    printf("[PCIe] Link speed set: Gen%d, Lane width: x%d\n", speed, width);
+    SIM_LOG("[PCIe] Link speed set: Gen%d, Lane width: x%d\n", speed, width);
     board_reg_write(BOARD_REG_PCI, 0x14);
 }
 
 void pci_link_training(void) {
     g_pci.ltssm_state = 1; // Simulate LTSSM in training
-    printf("[PCIe] Link training (LTSSM)...\n");
+    SIM_LOG("[PCIe] Link training (LTSSM)...\n");
     g_pci.ltssm_state = 2; // LTSSM in L0 (link up)
-    printf("[PCIe] LTSSM state: L0 (link up)\n");
+    SIM_LOG("[PCIe] LTSSM state: L0 (link up)\n");
     board_reg_write(BOARD_REG_PCI, 0x15);
 }
 
 void pci_linkup(void) {
     g_pci.link_up = 1;
-    printf("[PCIe] Link up!\n");
+    SIM_LOG("[PCIe] Link up!\n");
     board_reg_write(BOARD_REG_PCI, 1);
 }
 
@@ -97,25 +118,25 @@ void pci_reset_bars(void) {
         g_pci.bar[i] = 0;
         g_pci.bar_mask[i] = 0;
     }
-    printf("[PCIe] BARs reset.\n");
+    SIM_LOG("[PCIe] BARs reset.\n");
 }
 
 void pci_map_bar(int bar, uint32_t addr, uint32_t mask) {
     if (bar < 0 || bar >= PCI_NUM_BARS) return;
     g_pci.bar[bar] = addr;
     g_pci.bar_mask[bar] = mask;
-    printf("[PCIe] BAR%d mapped: addr=0x%08x mask=0x%08x\n", bar, addr, mask);
+    SIM_LOG("[PCIe] BAR%d mapped: addr=0x%08x mask=0x%08x\n", bar, addr, mask);
 }
 
 void pci_config_write(int offset, uint32_t value) {
     if (offset < 0 || offset >= 64) return;
     g_pci.config_space[offset] = value;
-    printf("[PCIe] Config write: offset=%d value=0x%08x\n", offset, value);
+    SIM_LOG("[PCIe] Config write: offset=%d value=0x%08x\n", offset, value);
 }
 
 uint32_t pci_config_read(int offset) {
     if (offset < 0 || offset >= 64) return 0;
-    printf("[PCIe] Config read: offset=%d\n", offset);
+    SIM_LOG("[PCIe] Config read: offset=%d\n", offset);
     return g_pci.config_space[offset];
 }
 
@@ -125,11 +146,11 @@ void pci_capability_add(uint8_t cap_id, const uint8_t *data, size_t len) {
             g_pci.caps[i].cap_id = cap_id;
             g_pci.caps[i].next_ptr = 0; // For demo
             memcpy(g_pci.caps[i].data, data, len > 14 ? 14 : len);
-            printf("[PCIe] Capability added: cap_id=0x%02x\n", cap_id);
+            SIM_LOG("[PCIe] Capability added: cap_id=0x%02x\n", cap_id);
             return;
         }
     }
-    printf("[PCIe] Capability table full!\n");
+    SIM_LOG("[PCIe] Capability table full!\n");
 }
 
 void pci_atu_configure(int region, atu_type_t type, uint32_t base, uint32_t limit, uint32_t target) {
@@ -138,50 +159,95 @@ void pci_atu_configure(int region, atu_type_t type, uint32_t base, uint32_t limi
     g_pci.atu[region].base = base;
     g_pci.atu[region].limit = limit;
     g_pci.atu[region].target = target;
-    printf("[PCIe] ATU region %d configured: %s base=0x%08x limit=0x%08x target=0x%08x\n", region, type == ATU_TYPE_INBOUND ? "INBOUND" : "OUTBOUND", base, limit, target);
+    SIM_LOG("[PCIe] ATU region %d configured: %s base=0x%08x limit=0x%08x target=0x%08x\n", region, type == ATU_TYPE_INBOUND ? "INBOUND" : "OUTBOUND", base, limit, target);
 }
 
-void pci_axi_write(uint32_t addr, uint32_t value) {
-    // Simulate ATU translation
+// Outbound ATU lookup; 0 if no region covers addr
+static int pci_atu_translate(uint32_t addr, uint32_t *translated) {
     for (int i = 0; i < PCI_NUM_ATU_REGIONS; ++i) {
         if (g_pci.atu[i].type == ATU_TYPE_OUTBOUND && addr >= g_pci.atu[i].base && addr <= g_pci.atu[i].limit) {
-            uint32_t translated = g_pci.atu[i].target + (addr - g_pci.atu[i].base);
-            printf("[PCIe] AXI write: addr=0x%08x (translated=0x%08x) value=0x%08x\n", addr, translated, value);
-            return;
+            *translated = g_pci.atu[i].target + (addr - g_pci.atu[i].base);
+            return 1;
         }
     }
-    printf("[PCIe] AXI write: addr=0x%08x (no ATU match) value=0x%08x\n", addr, value);
+    return 0;
+}
+
+void pci_axi_write(uint32_t addr, uint32_t value) {
+    // Simulate ATU translation
+    uint32_t translated;
+    if (pci_atu_translate(addr, &translated)) {
+        g_pci.axi_addr = translated;
+        g_pci.axi_data = value;
+        SIM_LOG("[PCIe] AXI write: addr=0x%08x (translated=0x%08x) value=0x%08x\n", addr, translated, value);
+        return;
+    }
+    SIM_LOG("[PCIe] AXI write: addr=0x%08x (no ATU match) value=0x%08x\n", addr, value);
 }
 
 uint32_t pci_axi_read(uint32_t addr) {
-    for (int i = 0; i < PCI_NUM_ATU_REGIONS; ++i) {
-        if (g_pci.atu[i].type == ATU_TYPE_OUTBOUND && addr >= g_pci.atu[i].base && addr <= g_pci.atu[i].limit) {
-            uint32_t translated = g_pci.atu[i].target + (addr - g_pci.atu[i].base);
-            printf("[PCIe] AXI read: addr=0x%08x (translated=0x%08x)\n", addr, translated);
-            return 0xDEADBEEF;
-        }
+    uint32_t translated;
+    if (pci_atu_translate(addr, &translated)) {
+        uint32_t value = translated == g_pci.axi_addr ? g_pci.axi_data : 0xDEADBEEF;
+        g_pci.axi_addr = translated;
+        SIM_LOG("[PCIe] AXI read: addr=0x%08x (translated=0x%08x)\n", addr, translated);
+        return value;
     }
-    printf("[PCIe] AXI read: addr=0x%08x (no ATU match)\n", addr);
+    SIM_LOG("[PCIe] AXI read: addr=0x%08x (no ATU match)\n", addr);
     return 0xDEADBEEF;
 }
 
+size_t pci_write_block(uint32_t addr, const void *data, size_t len) {
+    // One ATU lookup for the whole burst of posted 32-bit writes (last word zero-padded)
+    uint32_t translated, last;
+    size_t words = (len + 3) / 4;
+    if (len == 0 || words * 4 > PCI_OB_BUFFER_SIZE) {
+        SIM_LOG("[PCIe] Block write: %u bytes do not fit one burst\n", (unsigned)len);
+        return 0;
+    }
+    if (!pci_atu_translate(addr + (uint32_t)(words * 4) - 1, &last) || !pci_atu_translate(addr, &translated)) {
+        SIM_LOG("[PCIe] Block write: addr=0x%08x len=%u outside the outbound ATU windows\n", addr, (unsigned)len);
+        return 0;
+    }
+    // Little-endian 32-bit writes: the far end's memory holds the bytes in
+    // frame order, with the last word zero-padded
+    memcpy(g_pci.ob_data, data, len);
+    memset(g_pci.ob_data + len, 0, words * 4 - len);
+    g_pci.ob_addr = translated;
+    g_pci.ob_len = (uint32_t)len;
+    g_pci.tx_bytes += (uint32_t)len;
+    SIM_LOG("[PCIe] Block write: addr=0x%08x (translated=0x%08x) %u bytes in %u words\n",
+            addr, translated, (unsigned)len, (unsigned)words);
+    return len;
+}
+
+size_t pci_read_outbound(uint32_t *addr, void *data, size_t max) {
+    size_t n = g_pci.ob_len < max ? g_pci.ob_len : max;
+    if (addr) *addr = g_pci.ob_addr;
+    memcpy(data, g_pci.ob_data, n);
+    return n;
+}
+
 void pci_generate_interrupt(pci_int_type_t type, int vector) {
-    printf("[PCIe] Interrupt generated: type=%d vector=%d\n", type, vector);
+    SIM_LOG("[PCIe] Interrupt generated: type=%d vector=%d\n", type, vector);
+    if (type >= PCI_INT_NONE && type <= PCI_INT_INTC) {
+        g_pci.int_count[type]++;
+    }
     // Notify registered task(s)
     for (int i = 0; i < PCI_NUM_INT_TASKS; ++i) {
         if (g_pci.int_tasks[i].type == type && g_pci.int_tasks[i].vector == vector && g_pci.int_tasks[i].task) {
             xTaskNotifyGive(g_pci.int_tasks[i].task);
-            printf("[PCIe] Notified task for interrupt type=%d vector=%d\n", type, vector);
+            SIM_LOG("[PCIe] Notified task for interrupt type=%d vector=%d\n", type, vector);
         }
     }
     // For MSI/MSIX, also check vector tables
-    if (type == PCI_INT_MSI && vector < PCI_NUM_MSI_VECTORS && g_pci.msi[vector].enabled && !g_pci.msi[vector].masked && g_pci.msi[vector].task) {
+    if (type == PCI_INT_MSI && vector >= 0 && vector < PCI_NUM_MSI_VECTORS && g_pci.msi[vector].enabled && !g_pci.msi[vector].masked && g_pci.msi[vector].task) {
         xTaskNotifyGive(g_pci.msi[vector].task);
-        printf("[PCIe] MSI vector %d delivered to task\n", vector);
+        SIM_LOG("[PCIe] MSI vector %d delivered to task\n", vector);
     }
-    if (type == PCI_INT_MSIX && vector < PCI_NUM_MSIX_VECTORS && g_pci.msix[vector].enabled && !g_pci.msix[vector].masked && g_pci.msix[vector].task) {
+    if (type == PCI_INT_MSIX && vector >= 0 && vector < PCI_NUM_MSIX_VECTORS && g_pci.msix[vector].enabled && !g_pci.msix[vector].masked && g_pci.msix[vector].task) {
         xTaskNotifyGive(g_pci.msix[vector].task);
-        printf("[PCIe] MSIX vector %d delivered to task\n", vector);
+        SIM_LOG("[PCIe] MSIX vector %d delivered to task\n", vector);
     }
     board_reg_write(BOARD_REG_PCI, 2); // Simulate interrupt
 }
@@ -192,11 +258,11 @@ void pci_interrupt_register(pci_int_type_t type, int vector, TaskHandle_t task)
             g_pci.int_tasks[i].type = type;
             g_pci.int_tasks[i].vector = vector;
             g_pci.int_tasks[i].task = task;
-            printf("[PCIe] Task registered for interrupt type=%d vector=%d\n", type, vector);
+            SIM_LOG("[PCIe] Task registered for interrupt type=%d vector=%d\n", type, vector);
             return;
         }
     }
-    printf("[PCIe] Interrupt registration table full!\n");
+    SIM_LOG("[PCIe] Interrupt registration table full!\n");
 }
 
 void pci_msi_configure(int vector, TaskHandle_t task) {
@@ -204,7 +270,7 @@ void pci_msi_configure(int vector, TaskHandle_t task) {
     g_pci.msi[vector].enabled = 1;
     g_pci.msi[vector].masked = 0;
     g_pci.msi[vector].task = task;
-    printf("[PCIe] MSI vector %d configured for task\n", vector);
+    SIM_LOG("[PCIe] MSI vector %d configured for task\n", vector);
 }
 
 void pci_msix_configure(int vector, TaskHandle_t task) {
@@ -212,19 +278,19 @@ void pci_msix_configure(int vector, TaskHandle_t task) {
     g_pci.msix[vector].enabled = 1;
     g_pci.msix[vector].masked = 0;
     g_pci.msix[vector].task = task;
-    printf("[PCIe] MSIX vector %d configured for task\n", vector);
+    SIM_LOG("[PCIe] MSIX vector %d configured for task\n", vector);
 }
 
 void pci_send(const char *data) {
-    printf("[PCIe] Send: %s\n", data);
+    SIM_LOG("[PCIe] Send: %s\n", data);
 }
 
 void pci_receive(char *buffer, int maxlen) {
     snprintf(buffer, maxlen, "PCI_DATA");
-    printf("[PCIe] Receive: %s\n", buffer);
+    SIM_LOG("[PCIe] Receive: %s\n", buffer);
 }
 
 void pci_simulate_event(pci_int_type_t type, int vector) {
-    printf("[PCIe] Simulated event: type=%d vector=%d\n", type, vector);
+    SIM_LOG("[PCIe] Simulated event: type=%d vector=%d\n", type, vector);
     pci_generate_interrupt(type, vector);
 }
\ No newline at end of file
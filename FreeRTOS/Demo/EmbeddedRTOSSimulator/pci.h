@@ -13,6 +13,8 @@
 #define PCI_NUM_MSIX_VECTORS 8
 #define PCI_NUM_CAPS 4
 #define PCI_NUM_INT_TASKS 8
+#define PCI_EVENT_QUEUE_LEN 8
+#define PCI_OB_BUFFER_SIZE 128  // Largest posted burst pci_write_block() accepts
 
 // PCIe device type
 typedef enum {
@@ -112,11 +114,21 @@ struct pci_state {
     struct msix_vector msix[PCI_NUM_MSIX_VECTORS];
     struct pci_int_task_entry int_tasks[PCI_NUM_INT_TASKS];
     QueueHandle_t event_queue; // For event notification
+    uint32_t int_count[PCI_INT_INTC + 1]; // Interrupts generated, per pci_int_type_t
+    uint32_t tx_bytes;                    // Bytes posted through pci_write_block
+    uint8_t ob_data[PCI_OB_BUFFER_SIZE];  // Last posted burst as the far end received it
+    uint32_t ob_addr;                     // Its translated address
+    uint32_t ob_len;                      // Its length in bytes, before word padding
+    uint32_t axi_addr;                    // Translated address of the last AXI access
+    uint32_t axi_data;                    // Last word written through pci_axi_write
 };
 
 extern struct pci_state g_pci;
 
 void pci_init(pci_dev_type_t type, pci_link_speed_t speed, pci_lane_width_t width);
+// Warm start: load config space, BARs, ATU, MSI/MSI-X tables and link state
+// without the bring-up sequence. Task handles in `saved` must already be valid.
+void pci_restore(const struct pci_state *saved);
 void pci_clock_pll_init(void);
 void pci_perst_deassert(void);
 void pci_firmware_load(void);
@@ -131,8 +143,16 @@ void pci_config_write(int offset, uint32_t value);
 uint32_t pci_config_read(int offset);
 void pci_capability_add(uint8_t cap_id, const uint8_t *data, size_t len);
 void pci_atu_configure(int region, atu_type_t type, uint32_t base, uint32_t limit, uint32_t target);
+// Single-word AXI access through the outbound ATU. The last translated address
+// and written word are latched in g_pci; a read of that address returns the word.
 void pci_axi_write(uint32_t addr, uint32_t value);
 uint32_t pci_axi_read(uint32_t addr);
+// Posted burst through the outbound ATU (link frames); returns len, or 0 if
+// the range is not covered by the outbound windows or the burst is too long
+size_t pci_write_block(uint32_t addr, const void *data, size_t len);
+// Copies the last burst as written to the far end; returns its length and
+// the translated address it went to
+size_t pci_read_outbound(uint32_t *addr, void *data, size_t max);
 void pci_generate_interrupt(pci_int_type_t type, int vector);
 void pci_interrupt_register(pci_int_type_t type, int vector, TaskHandle_t task);
 void pci_msi_configure(int vector, TaskHandle_t task);
@@ -0,0 +1,204 @@
+#include "periodic.h"
+#include <string.h>
+
+#define TICKS_MS(t) ((unsigned)((t) * portTICK_PERIOD_MS))
+
+static struct periodic_task *registry[PERIODIC_MAX_TASKS];
+static size_t num_registered = 0;
+// Execution time rings, by registry slot: too big for the tasks' stacks
+static uint32_t exec_ring[PERIODIC_MAX_TASKS][PERIODIC_EXEC_SAMPLES];
+static uint32_t default_jitter_pct = PERIODIC_DEFAULT_JITTER_ALARM;
+static uint32_t default_response_pct = PERIODIC_DEFAULT_RESPONSE_ALARM;
+
+void periodic_set_default_alarms(uint32_t jitter_pct, uint32_t response_pct) {
+    default_jitter_pct = jitter_pct;
+    default_response_pct = response_pct;
+}
+
+static void task_init(struct periodic_task *pt, int sporadic, TickType_t period, TickType_t deadline) {
+    memset(pt, 0, sizeof(*pt));
+    strncpy(pt->name, pcTaskGetName(NULL), sizeof(pt->name) - 1);
+    pt->handle = xTaskGetCurrentTaskHandle();
+    pt->sporadic = sporadic;
+    pt->slot = -1;
+    pt->period = period;
+    pt->deadline = deadline;
+    // Events may come early or late, so a sporadic task has no release jitter
+    if (!sporadic) pt->jitter_alarm = (TickType_t)((uint64_t)period * default_jitter_pct / 100);
+    pt->response_alarm = (TickType_t)((uint64_t)deadline * default_response_pct / 100);
+    // Published with the scheduler suspended so periodic_snapshot() never sees half an entry
+    vTaskSuspendAll();
+    pt->release = xTaskGetTickCount();
+    if (num_registered < PERIODIC_MAX_TASKS) {
+        pt->slot = (int)num_registered;
+        registry[num_registered++] = pt;
+    }
+    (void)xTaskResumeAll();
+    if (pt->slot < 0) {
+        printf("[Periodic] Table full, %s is monitored but not reported\n", pt->name);
+    }
+}
+
+void periodic_init(struct periodic_task *pt, TickType_t period, TickType_t deadline) {
+    task_init(pt, 0, period, deadline);
+}
+
+void periodic_init_sporadic(struct periodic_task *pt, TickType_t min_interarrival, TickType_t deadline) {
+    task_init(pt, 1, min_interarrival, deadline);
+}
+
+void periodic_set_alarms(struct periodic_task *pt, TickType_t jitter, TickType_t response) {
+    pt->jitter_alarm = jitter;
+    pt->response_alarm = response;
+}
+
+// Bin 0 is 0 ticks, bin k holds [2^(k-1), 2^k), the last bin everything above
+static unsigned hist_bin(TickType_t t) {
+    unsigned b = 0;
+    while (t && b < PERIODIC_HIST_BINS - 1) {
+        t >>= 1;
+        b++;
+    }
+    return b;
+}
+
+static void hist_add(struct periodic_hist *h, TickType_t t) {
+    h->bins[hist_bin(t)]++;
+    if (t > h->max) h->max = t;
+    h->sum += t;
+}
+
+// The kernel adds to a task's run-time counter when it is switched out, so
+// the counter is exact right after the task blocked and was woken again. A
+// job that starts without having blocked is measured together with the next
+// one, which can only overstate the execution time.
+static void exec_sample(struct periodic_task *pt) {
+    TaskStatus_t st;
+    uint32_t c;
+    vTaskGetInfo(NULL, &st, pdFALSE, eRunning);
+    c = (uint32_t)st.ulRunTimeCounter - pt->run_mark;
+    pt->run_mark = (uint32_t)st.ulRunTimeCounter;
+    // The first mark is taken mid-slice, after start-up work that is not a job
+    if (!pt->exec_armed) {
+        pt->exec_armed = 1;
+        return;
+    }
+    if (pt->slot >= 0) exec_ring[pt->slot][pt->exec_jobs % PERIODIC_EXEC_SAMPLES] = c;
+    pt->exec_jobs++;
+    if (c > pt->exec_max) pt->exec_max = c;
+    pt->exec_sum += c;
+}
+
+// Response time of the job that just ended
+static TickType_t job_done(struct periodic_task *pt) {
+    TickType_t response = xTaskGetTickCount() - pt->release;
+
+    pt->jobs++;
+    hist_add(&pt->response, response);
+    if (response > pt->deadline) {
+        pt->misses++;
+        printf("[Periodic] %s missed its deadline: response %u ms > %u ms (job %u)\n",
+               pt->name, TICKS_MS(response), TICKS_MS(pt->deadline), (unsigned)pt->jobs);
+    } else if (pt->response_alarm && response >= pt->response_alarm) {
+        pt->alarms++;
+        printf("[Periodic] ALARM %s: response %u ms, alarm at %u ms, deadline %u ms (job %u)\n",
+               pt->name, TICKS_MS(response), TICKS_MS(pt->response_alarm), TICKS_MS(pt->deadline), (unsigned)pt->jobs);
+    }
+    return response;
+}
+
+void periodic_wait(struct periodic_task *pt) {
+    TickType_t response = job_done(pt);
+    TickType_t late, jitter;
+
+    // A job that overran several periods resumes at the latest missed release
+    // instead of running back-to-back catch-up jobs
+    late = response / pt->period;
+    if (late >= 2) {
+        pt->skipped += late - 1;
+        pt->release += (late - 1) * pt->period;
+    }
+    vTaskDelayUntil(&pt->release, pt->period);
+    // Only an on-time job blocks until the next release
+    if (late == 0) exec_sample(pt);
+    // Released: how long after the release the task actually got the CPU
+    jitter = xTaskGetTickCount() - pt->release;
+    hist_add(&pt->jitter, jitter);
+    if (pt->jitter_alarm && jitter >= pt->jitter_alarm) {
+        pt->alarms++;
+        printf("[Periodic] ALARM %s: release jitter %u ms, alarm at %u ms, period %u ms\n",
+               pt->name, TICKS_MS(jitter), TICKS_MS(pt->jitter_alarm), TICKS_MS(pt->period));
+    }
+}
+
+void periodic_job_begin(struct periodic_task *pt) {
+    pt->release = xTaskGetTickCount();
+    exec_sample(pt);
+}
+
+void periodic_job_end(struct periodic_task *pt) {
+    (void)job_done(pt);
+}
+
+size_t periodic_snapshot(struct periodic_task *out, size_t max) {
+    size_t n;
+    vTaskSuspendAll();
+    n = num_registered < max ? num_registered : max;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = *registry[i];
+    }
+    (void)xTaskResumeAll();
+    return n;
+}
+
+size_t periodic_exec_samples(const struct periodic_task *pt, uint32_t *out, size_t max) {
+    uint32_t jobs;
+    size_t n, first;
+    if (pt->slot < 0 || (size_t)pt->slot >= num_registered) return 0;
+    vTaskSuspendAll();
+    // The ring has moved on since the snapshot: index it by the live count
+    jobs = registry[pt->slot]->exec_jobs;
+    n = jobs < PERIODIC_EXEC_SAMPLES ? jobs : PERIODIC_EXEC_SAMPLES;
+    if (n > max) n = max;
+    // Oldest kept sample first
+    first = jobs - n;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = exec_ring[pt->slot][(first + i) % PERIODIC_EXEC_SAMPLES];
+    }
+    (void)xTaskResumeAll();
+    return n;
+}
+
+static void print_hist(FILE *f, const char *label, const struct periodic_hist *h) {
+    fprintf(f, "[Periodic]   %-9s", label);
+    for (unsigned b = 0; b < PERIODIC_HIST_BINS; ++b) {
+        unsigned lo = b ? 1u << (b - 1) : 0;
+        if (!h->bins[b]) continue;
+        if (b <= 1) {
+            fprintf(f, " %u:%u", TICKS_MS(lo), (unsigned)h->bins[b]);
+        } else if (b == PERIODIC_HIST_BINS - 1) {
+            fprintf(f, " %u+:%u", TICKS_MS(lo), (unsigned)h->bins[b]);
+        } else {
+            fprintf(f, " %u-%u:%u", TICKS_MS(lo), TICKS_MS(2 * lo - 1), (unsigned)h->bins[b]);
+        }
+    }
+    fprintf(f, " (ms:jobs)\n");
+}
+
+void periodic_print(FILE *f) {
+    // Static: a full snapshot is too big for the logger's stack
+    static struct periodic_task t[PERIODIC_MAX_TASKS];
+    size_t n = periodic_snapshot(t, PERIODIC_MAX_TASKS);
+    fprintf(f, "[Periodic] %-12s %6s %8s %7s %5s %5s %6s %8s %8s %8s %8s\n", "task", "period", "deadline",
+            "jobs", "miss", "skip", "alarms", "jit_max", "jit_avg", "resp_max", "resp_avg");
+    for (size_t i = 0; i < n; ++i) {
+        double jobs = t[i].jobs ? (double)t[i].jobs : 1.0;
+        fprintf(f, "[Periodic] %-12s %6u %8u %7u %5u %5u %6u %8u %8.1f %8u %8.1f\n", t[i].name,
+                TICKS_MS(t[i].period), TICKS_MS(t[i].deadline), (unsigned)t[i].jobs,
+                (unsigned)t[i].misses, (unsigned)t[i].skipped, (unsigned)t[i].alarms,
+                TICKS_MS(t[i].jitter.max), t[i].jitter.sum * portTICK_PERIOD_MS / jobs,
+                TICKS_MS(t[i].response.max), t[i].response.sum * portTICK_PERIOD_MS / jobs);
+        if (!t[i].sporadic) print_hist(f, "jitter", &t[i].jitter);
+        print_hist(f, "response", &t[i].response);
+    }
+}
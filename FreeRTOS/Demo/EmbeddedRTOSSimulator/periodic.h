@@ -0,0 +1,80 @@
+#ifndef PERIODIC_H
+#define PERIODIC_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Periodic tasks: a job is released every period by vTaskDelayUntil (no
+// drift from the time the job itself takes) and must finish within its
+// deadline, measured from the release. Per task the monitor records
+//   release jitter  first instruction after the release - release
+//   response time   end of job - release
+// as histograms, counts deadline misses and skipped releases, and prints an
+// alarm when jitter or response time crosses its threshold, before the
+// deadline is actually missed. Times are in ticks (1 ms at 1000 Hz).
+//
+// The execution time of each job is the growth of the task's own run-time
+// counter, so preemption and blocking are not counted. Sporadic tasks (woken
+// by an event rather than the clock) mark their jobs with periodic_job_begin()
+// and periodic_job_end() instead of calling periodic_wait().
+#define PERIODIC_MAX_TASKS          8
+#define PERIODIC_HIST_BINS          16  // 0, 1, 2-3, 4-7, ... 16384+ ticks
+#define PERIODIC_EXEC_SAMPLES       256 // Latest job execution times kept per task
+#define PERIODIC_DEFAULT_JITTER_ALARM   10  // Percent of the period
+#define PERIODIC_DEFAULT_RESPONSE_ALARM 80  // Percent of the deadline
+
+struct periodic_hist {
+    uint32_t bins[PERIODIC_HIST_BINS];
+    uint32_t max;
+    uint64_t sum;
+};
+
+struct periodic_task {
+    char name[configMAX_TASK_NAME_LEN];
+    TaskHandle_t handle;
+    int sporadic;               // Period is the minimum time between events
+    int slot;                   // Registry index, -1 = not registered
+    TickType_t period;
+    TickType_t deadline;        // Relative to the release
+    TickType_t jitter_alarm;    // Thresholds in ticks, 0 = off
+    TickType_t response_alarm;
+    TickType_t release;         // Current job
+    uint32_t jobs;              // Completed jobs
+    uint32_t misses;            // Jobs that finished after their deadline
+    uint32_t skipped;           // Releases that passed while a job overran
+    uint32_t alarms;
+    struct periodic_hist jitter;
+    struct periodic_hist response;
+    uint32_t run_mark;          // Run-time counter at the start of the current job
+    int exec_armed;             // run_mark is valid
+    uint32_t exec_jobs;         // Execution times measured
+    uint32_t exec_max;          // Run-time counter units
+    uint64_t exec_sum;
+};
+
+// Alarm thresholds for tasks initialised afterwards, in percent (0 = off)
+void periodic_set_default_alarms(uint32_t jitter_pct, uint32_t response_pct);
+
+// Called by the task itself with storage that lives as long as the task (a
+// local of a task function that never returns will do); the first release is now
+void periodic_init(struct periodic_task *pt, TickType_t period, TickType_t deadline);
+// Override the default thresholds (ticks, 0 = off)
+void periodic_set_alarms(struct periodic_task *pt, TickType_t jitter, TickType_t response);
+// Ends the current job and blocks until the next release
+void periodic_wait(struct periodic_task *pt);
+
+// Sporadic task: jobs start when an event arrives, at least min_interarrival apart
+void periodic_init_sporadic(struct periodic_task *pt, TickType_t min_interarrival, TickType_t deadline);
+// Call right after the blocking call that delivered the event
+void periodic_job_begin(struct periodic_task *pt);
+void periodic_job_end(struct periodic_task *pt);
+
+size_t periodic_snapshot(struct periodic_task *out, size_t max);
+// Copies the latest execution times of a snapshot entry (run-time counter
+// units, oldest first); returns how many were copied
+size_t periodic_exec_samples(const struct periodic_task *pt, uint32_t *out, size_t max);
+void periodic_print(FILE *f);
+
+#endif // PERIODIC_H
@@ -0,0 +1,19 @@
+#ifndef PROTOCOL_LINK_H
+#define PROTOCOL_LINK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "task_scheduler.h"
+
+#define PROTOCOL_PCIE_ADDR  0x80000000  // Outbound ATU window the frames are posted to
+
+// Sends link frames on UART, SPI and PCIe and checks what came back: the
+// UART peer's frames are parsed and counted, the SPI loopback copy and the
+// PCIe outbound copy must decode to the frame just sent. A link that takes
+// fewer bytes than the frame counts as a link error.
+void protocol_link_init(void);
+// Fills in the link fields of log; log->msg and log->samples describe the
+// samples in the frame, for the loopback check
+void protocol_link_send(const uint8_t *frame, size_t n, uint16_t seq, protocol_log_t *log);
+
+#endif // PROTOCOL_LINK_H
@@ -0,0 +1,146 @@
+#include "queue_stats.h"
+#include "task.h"
+#include "task_scheduler.h"
+#include "sim_log.h"
+#include <stdio.h>
+
+// A blocked queue call, tracked per task (indexed by its task number)
+struct pending_block {
+    unsigned long queue_number; // 0 = not blocked
+    int on_send;
+    TickType_t since;
+};
+
+static struct queue_stats_entry entries[QUEUE_STATS_MAX];
+static size_t num_entries = 0;
+static struct pending_block pending[SIM_MAX_TASKS + 1]; // [0] unused
+// Longest single blocked send [1] and receive [0] per task number
+static TickType_t longest_block[SIM_MAX_TASKS + 1][2];
+
+void queue_stats_register(QueueHandle_t queue, const char *name, UBaseType_t length, UBaseType_t item_size) {
+    if (queue == NULL) return;
+    if (num_entries >= QUEUE_STATS_MAX) {
+        SIM_LOG("[QueueStats] Registry full, %s not tracked\n", name);
+        return;
+    }
+    struct queue_stats_entry *e = &entries[num_entries];
+    e->handle = queue;
+    e->name = name;
+    e->length = length;
+    e->item_size = item_size;
+    e->peak = uxQueueMessagesWaiting(queue);
+    // Named in the kernel registry for kernel-aware debuggers
+    vQueueAddToRegistry(queue, name);
+    // The queue number lets the trace hooks find the entry in O(1)
+    vQueueSetQueueNumber(queue, (UBaseType_t)(++num_entries));
+}
+
+size_t queue_stats_snapshot(struct queue_stats_entry *out, size_t max) {
+    size_t n;
+    vTaskSuspendAll();
+    n = num_entries < max ? num_entries : max;
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = entries[i];
+        out[i].waiting = uxQueueMessagesWaiting(entries[i].handle);
+    }
+    (void)xTaskResumeAll();
+    return num_entries;
+}
+
+void queue_stats_task_blocking(UBaseType_t task_number, TickType_t *send, TickType_t *receive) {
+    *send = *receive = 0;
+    if (task_number < 1 || task_number > SIM_MAX_TASKS) return;
+    vTaskSuspendAll();
+    *send = longest_block[task_number][1];
+    *receive = longest_block[task_number][0];
+    (void)xTaskResumeAll();
+}
+
+void queue_stats_print(FILE *f) {
+    struct queue_stats_entry q[QUEUE_STATS_MAX];
+    size_t n = queue_stats_snapshot(q, QUEUE_STATS_MAX);
+    fprintf(f, "[QueueStats] %-18s %7s %5s %8s %8s %6s %6s %8s %8s\n", "queue", "wait", "peak",
+            "sends", "recvs", "full", "empty", "blk_tx", "blk_rx");
+    for (size_t i = 0; i < n; ++i) {
+        fprintf(f, "[QueueStats] %-18s %3lu/%-3lu %5lu %8u %8u %6u %6u %8llu %8llu\n", q[i].name,
+                (unsigned long)q[i].waiting, (unsigned long)q[i].length, (unsigned long)q[i].peak,
+                (unsigned)q[i].sends, (unsigned)q[i].receives,
+                (unsigned)q[i].send_failures, (unsigned)q[i].receive_failures,
+                (unsigned long long)q[i].send_blocked_ticks, (unsigned long long)q[i].receive_blocked_ticks);
+    }
+}
+
+// --- Trace hooks: run inside kernel critical sections ---
+
+static struct queue_stats_entry *entry_for(unsigned long queue_number) {
+    if (queue_number == 0 || queue_number > num_entries) return NULL;
+    return &entries[queue_number - 1];
+}
+
+static struct pending_block *current_pending(void) {
+    UBaseType_t task_number = uxTaskGetTaskNumber(xTaskGetCurrentTaskHandle());
+    // Task number 0: not created through SIM_TASK_CREATE, blocking not timed
+    return task_number >= 1 && task_number <= SIM_MAX_TASKS ? &pending[task_number] : NULL;
+}
+
+// A send/receive call finished: charge the time its task spent blocked
+static void end_block(struct queue_stats_entry *e, unsigned long queue_number, int on_send) {
+    struct pending_block *p = current_pending();
+    TickType_t blocked;
+    if (p == NULL || p->queue_number != queue_number || p->on_send != on_send) return;
+    blocked = xTaskGetTickCount() - p->since;
+    if (on_send) e->send_blocked_ticks += blocked;
+    else e->receive_blocked_ticks += blocked;
+    if (blocked > longest_block[p - pending][on_send]) longest_block[p - pending][on_send] = blocked;
+    p->queue_number = 0;
+}
+
+void queue_stats_trace_send(unsigned long queue_number, unsigned long waiting) {
+    struct queue_stats_entry *e = entry_for(queue_number);
+    if (e == NULL) return;
+    e->sends++;
+    if (waiting > e->peak) e->peak = waiting;
+    end_block(e, queue_number, 1);
+}
+
+void queue_stats_trace_send_from_isr(unsigned long queue_number, unsigned long waiting) {
+    struct queue_stats_entry *e = entry_for(queue_number);
+    if (e == NULL) return;
+    e->sends++;
+    if (waiting > e->peak) e->peak = waiting;
+}
+
+void queue_stats_trace_send_failed(unsigned long queue_number, int from_isr) {
+    struct queue_stats_entry *e = entry_for(queue_number);
+    if (e == NULL) return;
+    e->send_failures++;
+    if (!from_isr) end_block(e, queue_number, 1);
+}
+
+void queue_stats_trace_receive(unsigned long queue_number, int from_isr) {
+    struct queue_stats_entry *e = entry_for(queue_number);
+    if (e == NULL) return;
+    e->receives++;
+    if (!from_isr) end_block(e, queue_number, 0);
+}
+
+void queue_stats_trace_receive_failed(unsigned long queue_number, int from_isr) {
+    struct queue_stats_entry *e = entry_for(queue_number);
+    if (e == NULL) return;
+    e->receive_failures++;
+    if (!from_isr) end_block(e, queue_number, 0);
+}
+
+void queue_stats_trace_blocking(unsigned long queue_number, int on_send) {
+    struct queue_stats_entry *e = entry_for(queue_number);
+    struct pending_block *p;
+    if (e == NULL || (p = current_pending()) == NULL) return;
+    // A woken task that finds the queue full/empty again blocks once more:
+    // keep the original start so the whole wait is counted
+    if (p->queue_number == queue_number && p->on_send == on_send) return;
+    if (on_send) e->send_blocks++;
+    else e->receive_blocks++;
+    p->queue_number = queue_number;
+    p->on_send = on_send;
+    p->since = xTaskGetTickCount();
+}
@@ -0,0 +1,48 @@
+#ifndef QUEUE_STATS_H
+#define QUEUE_STATS_H
+
+#include "FreeRTOS.h"
+#include "queue.h"
+#include <stdio.h>
+
+#define QUEUE_STATS_MAX 8   // Matches configQUEUE_REGISTRY_SIZE
+
+// Per-queue telemetry, fed by the queue trace hooks in FreeRTOSConfig.h.
+// Blocked time is in ticks and counted when the blocked call returns.
+struct queue_stats_entry {
+    QueueHandle_t handle;
+    const char *name;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t waiting;    // Items waiting when the snapshot was taken
+    UBaseType_t peak;       // Highest number of items ever waiting
+    uint32_t sends;
+    uint32_t receives;
+    uint32_t send_failures;     // Queue full: timed out or did not wait
+    uint32_t receive_failures;  // Queue empty: timed out or did not wait
+    uint32_t send_blocks;       // Sends that had to wait for space
+    uint32_t receive_blocks;    // Receives that had to wait for data
+    uint64_t send_blocked_ticks;
+    uint64_t receive_blocked_ticks;
+};
+
+// Start tracking a queue and add it to the kernel queue registry. Call once,
+// right after creating it.
+void queue_stats_register(QueueHandle_t queue, const char *name, UBaseType_t length, UBaseType_t item_size);
+// Copies up to max entries; returns the number of registered queues
+size_t queue_stats_snapshot(struct queue_stats_entry *out, size_t max);
+void queue_stats_print(FILE *f);
+// Longest single blocked send and receive of a task (by its task number), in
+// ticks, over all tracked queues and semaphores
+void queue_stats_task_blocking(UBaseType_t task_number, TickType_t *send, TickType_t *receive);
+
+// Trace hook entry points, called inside queue.c (see FreeRTOSConfig.h). The
+// queue number is 1-based; 0 means the queue is not tracked.
+void queue_stats_trace_send(unsigned long queue_number, unsigned long waiting);
+void queue_stats_trace_send_from_isr(unsigned long queue_number, unsigned long waiting);
+void queue_stats_trace_send_failed(unsigned long queue_number, int from_isr);
+void queue_stats_trace_receive(unsigned long queue_number, int from_isr);
+void queue_stats_trace_receive_failed(unsigned long queue_number, int from_isr);
+void queue_stats_trace_blocking(unsigned long queue_number, int on_send);
+
+#endif // QUEUE_STATS_H
@@ -0,0 +1,300 @@
+#include "replay.h"
+#include "task.h"
+#include "uart.h"
+#include "spi.h"
+#include "task_scheduler.h"
+#include "sim_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define REPLAY_LINE_MAX 256
+#define REPLAY_LOOP_SUMMARY_MS 10000  // --replay-loop: totals at most this often, not per pass
+
+static replay_trace_t g_trace;
+static uint32_t replay_rate = REPLAY_RATE_REAL;
+static int replay_loop = 0;
+static uint32_t injected[REPLAY_EV_COUNT];
+static uint32_t sensor_dropped = 0;
+static uint32_t passes = 0;
+static uint32_t rx_dropped = 0;             // UART/SPI payload bytes the RX rings had no room for
+
+static const char *const event_names[REPLAY_EV_COUNT] = { "UART", "SPI", "PCIE", "SENSOR" };
+
+// --- Trace reader ---
+
+int replay_trace_open(replay_trace_t *trace, const char *path) {
+    struct stat st;
+    void *map;
+    int fd = open(path, O_RDONLY);
+    memset(trace, 0, sizeof(*trace));
+    if (fd < 0) {
+        printf("[Replay] Cannot open trace %s\n", path);
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        printf("[Replay] Trace %s is empty\n", path);
+        close(fd);
+        return -1;
+    }
+    // The mapping stays valid after close(); pages are faulted in as the
+    // cursor advances, so the trace is never loaded as a whole.
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("[Replay] Cannot map trace %s\n", path);
+        return -1;
+    }
+    madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+    trace->base = map;
+    trace->size = (size_t)st.st_size;
+    return 0;
+}
+
+void replay_trace_close(replay_trace_t *trace) {
+    if (trace->base) {
+        munmap((void *)trace->base, trace->size);
+    }
+    memset(trace, 0, sizeof(*trace));
+}
+
+void replay_trace_rewind(replay_trace_t *trace) {
+    trace->pos = 0;
+    trace->line = 0;
+}
+
+static int hex_value(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+static int parse_uart_payload(const char *s, replay_event_t *ev) {
+    size_t n = 0;
+    while (*s && n < REPLAY_MAX_PAYLOAD) {
+        char c = *s++;
+        if (c == '\\' && *s) {
+            char e = *s++;
+            switch (e) {
+                case 'n': c = '\n'; break;
+                case 'r': c = '\r'; break;
+                case 't': c = '\t'; break;
+                case 'x': {
+                    int hi = hex_value(s[0]);
+                    int lo = hi >= 0 ? hex_value(s[1]) : -1;
+                    if (lo < 0) return -1;
+                    c = (char)(hi << 4 | lo);
+                    s += 2;
+                    break;
+                }
+                default: c = e; break;
+            }
+        }
+        ev->data[n++] = c;
+    }
+    ev->len = n;
+    ev->data[n] = '\0';
+    return 0;
+}
+
+static int parse_spi_payload(const char *s, replay_event_t *ev) {
+    size_t n = 0;
+    while (*s && n < REPLAY_MAX_PAYLOAD) {
+        int hi, lo;
+        if (isspace((unsigned char)*s)) { ++s; continue; }
+        hi = hex_value(s[0]);
+        lo = hi >= 0 ? hex_value(s[1]) : -1;
+        if (lo < 0) return -1;
+        ev->data[n++] = (char)(hi << 4 | lo);
+        s += 2;
+    }
+    ev->len = n;
+    ev->data[n] = '\0';
+    return 0;
+}
+
+static int parse_pcie_type(const char *s, pci_int_type_t *type) {
+    if (strcmp(s, "LEGACY") == 0) *type = PCI_INT_LEGACY;
+    else if (strcmp(s, "MSI") == 0) *type = PCI_INT_MSI;
+    else if (strcmp(s, "MSIX") == 0) *type = PCI_INT_MSIX;
+    else if (strcmp(s, "INTC") == 0) *type = PCI_INT_INTC;
+    else return -1;
+    return 0;
+}
+
+// Vectors index the MSI/MSI-X tables; legacy and INTC only need a sane number
+static int vector_valid(pci_int_type_t type, int vector) {
+    if (vector < 0) return 0;
+    if (type == PCI_INT_MSI) return vector < PCI_NUM_MSI_VECTORS;
+    if (type == PCI_INT_MSIX) return vector < PCI_NUM_MSIX_VECTORS;
+    return 1;
+}
+
+static int replay_parse_line(char *line, replay_event_t *ev) {
+    char kind[8], arg[8];
+    int consumed = 0;
+    unsigned long t;
+    char *p = line, *end;
+
+    while (isspace((unsigned char)*p)) ++p;
+    if (*p == '\0' || *p == '#') return 0;
+    t = strtoul(p, &end, 10);
+    if (end == p || sscanf(end, " %7s %n", kind, &consumed) != 1) return -1;
+    p = end + consumed;
+    memset(ev, 0, sizeof(*ev));
+    ev->time_ms = (uint32_t)t;
+    if (strcmp(kind, "UART") == 0) {
+        ev->type = REPLAY_EV_UART;
+        return parse_uart_payload(p, ev) == 0 ? 1 : -1;
+    } else if (strcmp(kind, "SPI") == 0) {
+        ev->type = REPLAY_EV_SPI;
+        return parse_spi_payload(p, ev) == 0 ? 1 : -1;
+    } else if (strcmp(kind, "PCIE") == 0) {
+        ev->type = REPLAY_EV_PCIE;
+        if (sscanf(p, "%7s %d", arg, &ev->vector) != 2 || parse_pcie_type(arg, &ev->int_type) != 0 ||
+            !vector_valid(ev->int_type, ev->vector)) return -1;
+        return 1;
+    } else if (strcmp(kind, "SENSOR") == 0) {
+        ev->type = REPLAY_EV_SENSOR;
+        return sscanf(p, "%d", &ev->sensor_value) == 1 ? 1 : -1;
+    }
+    return -1;
+}
+
+int replay_trace_next(replay_trace_t *trace, replay_event_t *ev) {
+    char line[REPLAY_LINE_MAX];
+    while (trace->pos < trace->size) {
+        const char *start = trace->base + trace->pos;
+        const char *nl = memchr(start, '\n', trace->size - trace->pos);
+        size_t len = nl ? (size_t)(nl - start) : trace->size - trace->pos;
+        int r;
+        trace->pos += len + (nl ? 1 : 0);
+        trace->line++;
+        if (len > 0 && start[len - 1] == '\r') --len;
+        if (len >= sizeof(line)) {
+            printf("[Replay] Line %u too long, skipped\n", (unsigned)trace->line);
+            continue;
+        }
+        memcpy(line, start, len);
+        line[len] = '\0';
+        r = replay_parse_line(line, ev);
+        if (r > 0) return 1;
+        if (r < 0) printf("[Replay] Line %u malformed, skipped\n", (unsigned)trace->line);
+    }
+    return 0;
+}
+
+// --- Replay engine ---
+
+int replay_init(const char *path, uint32_t rate, int loop) {
+    replay_event_t ev;
+    if (replay_trace_open(&g_trace, path) != 0) {
+        return -1;
+    }
+    // Nothing to inject would leave the task with no reason ever to block
+    if (!replay_trace_next(&g_trace, &ev)) {
+        printf("[Replay] Trace %s has no events\n", path);
+        replay_trace_close(&g_trace);
+        return -1;
+    }
+    replay_trace_rewind(&g_trace);
+    replay_rate = rate;
+    replay_loop = loop;
+    memset(injected, 0, sizeof(injected));
+    sensor_dropped = 0;
+    passes = 0;
+    rx_dropped = 0;
+    if (rate == REPLAY_RATE_MAX) {
+        printf("[Replay] Trace %s (%lu bytes), maximum rate\n", path, (unsigned long)g_trace.size);
+    } else {
+        printf("[Replay] Trace %s (%lu bytes), %ux recorded rate\n", path, (unsigned long)g_trace.size, (unsigned)rate);
+    }
+    return 0;
+}
+
+static void replay_inject(const replay_event_t *ev) {
+    switch (ev->type) {
+        case REPLAY_EV_UART:
+            rx_dropped += (uint32_t)(ev->len - uart_simulate_rx_bytes(ev->data, ev->len));
+            xEventGroupSetBits(egSystemEvents, EV_SYSTEM_UART_RX);
+            break;
+        case REPLAY_EV_SPI:
+            rx_dropped += (uint32_t)(ev->len - spi_simulate_rx_bytes(ev->data, ev->len));
+            xEventGroupSetBits(egSystemEvents, EV_SYSTEM_SPI_RX);
+            break;
+        case REPLAY_EV_PCIE:
+            pci_simulate_event(ev->int_type, ev->vector);
+            signal_pcie_event();
+            break;
+        case REPLAY_EV_SENSOR: {
+            sensor_msg_t msg = { .sensor_value = ev->sensor_value, .timestamp = xTaskGetTickCount() };
+            if (send_sensor_data(&msg, 0) != pdTRUE) {
+                ++sensor_dropped;
+            }
+            break;
+        }
+        default:
+            return;
+    }
+    ++injected[ev->type];
+}
+
+static void replay_print_summary(void) {
+    printf("[Replay] Done, %u pass(es): UART=%u SPI=%u PCIE=%u SENSOR=%u (sensor dropped=%u, RX bytes dropped=%u)\n",
+           (unsigned)passes, (unsigned)injected[REPLAY_EV_UART], (unsigned)injected[REPLAY_EV_SPI],
+           (unsigned)injected[REPLAY_EV_PCIE], (unsigned)injected[REPLAY_EV_SENSOR], (unsigned)sensor_dropped,
+           (unsigned)rx_dropped);
+}
+
+// --- Replay Task: injects trace events at recorded, scaled or maximum rate ---
+void vReplayTask(void *pvParameters) {
+    replay_event_t ev;
+    TickType_t start = xTaskGetTickCount();
+    TickType_t last_summary = 0;
+    uint32_t burst = 0;
+    for (;;) {
+        if (!replay_trace_next(&g_trace, &ev)) {
+            TickType_t now = xTaskGetTickCount();
+            ++passes;
+            if (!replay_loop || passes == 1 || now - last_summary >= pdMS_TO_TICKS(REPLAY_LOOP_SUMMARY_MS)) {
+                replay_print_summary();
+                last_summary = now;
+            }
+            if (!replay_loop) {
+                break;
+            }
+            replay_trace_rewind(&g_trace);
+            // Every pass takes at least a tick: a trace with all events at
+            // t=0 would otherwise keep the lower priorities off the CPU
+            vTaskDelay(1);
+            start = xTaskGetTickCount();
+            burst = 0;
+            continue;
+        }
+        if (replay_rate == REPLAY_RATE_MAX) {
+            // Let the consumers drain between bursts
+            if (++burst >= REPLAY_MAX_BURST) {
+                burst = 0;
+                vTaskDelay(1);
+            }
+        } else {
+            TickType_t due = start + (TickType_t)((uint64_t)ev.time_ms * configTICK_RATE_HZ / (1000ull * replay_rate));
+            TickType_t now = xTaskGetTickCount();
+            if ((int32_t)(due - now) > 0) {
+                vTaskDelay(due - now);
+            }
+        }
+        SIM_LOG("[Replay] t=%u ms %s\n", (unsigned)ev.time_ms, event_names[ev.type]);
+        replay_inject(&ev);
+    }
+    replay_trace_close(&g_trace);
+    for (;;) {
+        vTaskDelay(portMAX_DELAY);
+    }
+}
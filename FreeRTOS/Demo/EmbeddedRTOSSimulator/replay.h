@@ -0,0 +1,57 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "pci.h"
+
+// Trace file format: one event per line, '#' starts a comment.
+//   <time_ms> UART   <text>         bytes, C escapes \n \r \t \\ \xNN
+//   <time_ms> SPI    <hex bytes>    e.g. 0a1b2c
+//   <time_ms> PCIE   <type> <vec>   type = LEGACY|MSI|MSIX|INTC, vec >= 0 and
+//                                  below PCI_NUM_MSI(X)_VECTORS for MSI/MSIX
+//   <time_ms> SENSOR <value>
+// Times are milliseconds from the start of the trace, non-decreasing.
+
+#define REPLAY_MAX_PAYLOAD 64
+#define REPLAY_RATE_MAX    0   // Inject as fast as the system accepts
+#define REPLAY_RATE_REAL   1   // Recorded timing
+#define REPLAY_MAX_BURST   32  // Events injected per tick at REPLAY_RATE_MAX
+
+typedef enum {
+    REPLAY_EV_UART = 0,
+    REPLAY_EV_SPI,
+    REPLAY_EV_PCIE,
+    REPLAY_EV_SENSOR,
+    REPLAY_EV_COUNT
+} replay_event_type_t;
+
+typedef struct {
+    uint32_t time_ms;
+    replay_event_type_t type;
+    pci_int_type_t int_type;
+    int vector;
+    int sensor_value;
+    size_t len;
+    char data[REPLAY_MAX_PAYLOAD + 1]; // UART/SPI payload, len bytes (may contain NUL)
+} replay_event_t;
+
+// Read cursor over a memory-mapped trace file
+typedef struct {
+    const char *base;
+    size_t size;
+    size_t pos;
+    uint32_t line;
+} replay_trace_t;
+
+int replay_trace_open(replay_trace_t *trace, const char *path);
+void replay_trace_close(replay_trace_t *trace);
+void replay_trace_rewind(replay_trace_t *trace);
+// Returns 1 with *ev filled, 0 at end of trace. Malformed lines are skipped.
+int replay_trace_next(replay_trace_t *trace, replay_event_t *ev);
+
+// Replay engine: rate is REPLAY_RATE_MAX, REPLAY_RATE_REAL or a speed-up factor
+int replay_init(const char *path, uint32_t rate, int loop);
+void vReplayTask(void *pvParameters);
+
+#endif // REPLAY_H
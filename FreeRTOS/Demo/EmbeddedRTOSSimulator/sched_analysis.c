@@ -0,0 +1,246 @@
+#include "sched_analysis.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "task_scheduler.h"
+#include "periodic.h"
+#include "queue_stats.h"
+#include "sim_config.h"
+#include <stdlib.h>
+
+#define TICK_US             (1000000u / configTICK_RATE_HZ)
+#define MAX_SCALE_PCT       100000  // Headroom search stops at 1000x
+
+// One analysed task; times in microseconds
+struct rta_task {
+    const char *name;
+    int sporadic;
+    UBaseType_t prio;       // Current priority
+    UBaseType_t rm_prio;    // Rate-monotonic suggestion
+    uint32_t jobs;          // Jobs with a measured execution time
+    uint64_t t, d, c, b;
+    uint64_t c50, c90, c99;
+};
+
+static const char *report_path = NULL;
+
+static uint64_t ticks_us(TickType_t t) {
+    return (uint64_t)t * TICK_US;
+}
+
+// Run-time counter units to microseconds, rounded up
+static uint64_t counts_us(uint64_t counts, double us_per_count) {
+    double us = (double)counts * us_per_count;
+    uint64_t whole = (uint64_t)us;
+    return whole + (us > (double)whole);
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Nearest-rank percentile of sorted samples
+static uint32_t percentile(const uint32_t *s, size_t n, unsigned pct) {
+    size_t rank = (n * pct + 99) / 100;
+    return n ? s[rank ? rank - 1 : 0] : 0;
+}
+
+// Worst-case response time of task i with every execution time scaled by
+// scale_pct. Equal priorities interfere too: the kernel time-slices them.
+// Stops as soon as the deadline is exceeded, so a result above d only means
+// "misses".
+static uint64_t response_time(const struct rta_task *t, size_t n, size_t i, int rm, uint32_t scale_pct) {
+    UBaseType_t prio = rm ? t[i].rm_prio : t[i].prio;
+    uint64_t base = t[i].c * scale_pct / 100 + t[i].b;
+    uint64_t r = base, prev = 0;
+    while (r != prev && r <= t[i].d) {
+        prev = r;
+        r = base;
+        for (size_t j = 0; j < n; ++j) {
+            if (j == i || (rm ? t[j].rm_prio : t[j].prio) < prio) continue;
+            r += (prev + t[j].t - 1) / t[j].t * (t[j].c * scale_pct / 100);
+        }
+    }
+    return r;
+}
+
+static int schedulable(const struct rta_task *t, size_t n, int rm, uint32_t scale_pct) {
+    for (size_t i = 0; i < n; ++i) {
+        if (response_time(t, n, i, rm, scale_pct) > t[i].d) return 0;
+    }
+    return 1;
+}
+
+// Largest scale (percent) at which the set is still schedulable, 0 if none
+static uint32_t headroom(const struct rta_task *t, size_t n, int rm) {
+    uint32_t lo = 0, hi = MAX_SCALE_PCT;
+    if (schedulable(t, n, rm, hi)) return hi;
+    while (hi - lo > 1) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (schedulable(t, n, rm, mid)) lo = mid;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int cmp_rate_monotonic(const void *a, const void *b) {
+    const struct rta_task *x = *(const struct rta_task * const *)a;
+    const struct rta_task *y = *(const struct rta_task * const *)b;
+    // Shorter period first; equal periods by deadline
+    if (x->t != y->t) return x->t < y->t ? -1 : 1;
+    return x->d < y->d ? -1 : x->d > y->d;
+}
+
+// One priority level per distinct (period, deadline), from the highest
+// priority the analysed tasks use now downwards
+static void assign_rate_monotonic(struct rta_task *t, size_t n, struct rta_task **order) {
+    UBaseType_t top = 0, levels = 0;
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = &t[i];
+        if (t[i].prio > top) top = t[i].prio;
+    }
+    qsort(order, n, sizeof(order[0]), cmp_rate_monotonic);
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 0 || cmp_rate_monotonic(&order[i - 1], &order[i]) != 0) levels++;
+    }
+    if (top < levels) top = levels;
+    levels = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (i == 0 || cmp_rate_monotonic(&order[i - 1], &order[i]) != 0) levels++;
+        order[i]->rm_prio = top + 1 - levels;
+    }
+}
+
+static void write_rta(FILE *f, const struct rta_task *t, size_t n, int rm) {
+    fprintf(f, "  %-12s %4s %8s %8s %9s %8s %9s %9s\n", "task", "prio", "T (ms)", "D (ms)", "C (us)",
+            "B (ms)", "R (ms)", "slack");
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t r = response_time(t, n, i, rm, 100);
+        fprintf(f, "  %-12s %4u %8.1f %8.1f %9llu %8.1f", t[i].name, (unsigned)(rm ? t[i].rm_prio : t[i].prio),
+                t[i].t / 1000.0, t[i].d / 1000.0, (unsigned long long)t[i].c, t[i].b / 1000.0);
+        if (r > t[i].d) {
+            fprintf(f, " %9s %9s  MISSES\n", "> D", "-");
+        } else {
+            fprintf(f, " %9.3f %9.3f\n", r / 1000.0, (t[i].d - r) / 1000.0);
+        }
+    }
+}
+
+static void write_headroom(FILE *f, const struct rta_task *t, size_t n, int rm) {
+    uint32_t pct = headroom(t, n, rm);
+    if (pct >= MAX_SCALE_PCT) {
+        fprintf(f, "  Schedulable with execution times (or all rates) raised over %ux\n", MAX_SCALE_PCT / 100);
+    } else if (pct >= 100) {
+        fprintf(f, "  Schedulable; execution times (or all rates) can grow %.2fx before a deadline is missed\n",
+                pct / 100.0);
+    } else if (pct > 0) {
+        fprintf(f, "  NOT schedulable; execution times (or all rates) must drop to %u%%\n", (unsigned)pct);
+    } else {
+        fprintf(f, "  NOT schedulable: blocking alone exceeds a deadline\n");
+    }
+}
+
+void sched_analysis_write(FILE *f) {
+    // Static: run from atexit, but kept off whatever stack calls it
+    static struct periodic_task pt[PERIODIC_MAX_TASKS];
+    static struct rta_task t[PERIODIC_MAX_TASKS];
+    static struct rta_task *order[PERIODIC_MAX_TASKS];
+    static uint32_t samples[PERIODIC_EXEC_SAMPLES];
+    static TaskStatus_t status[SIM_MAX_TASKS];
+    const struct task_info *tasks;
+    size_t ntasks = task_scheduler_get_tasks(&tasks);
+    size_t n = periodic_snapshot(pt, PERIODIC_MAX_TASKS);
+    TickType_t now = xTaskGetTickCount();
+    UBaseType_t nstatus = uxTaskGetSystemState(status, SIM_MAX_TASKS, NULL);
+    UBaseType_t lowest = configMAX_PRIORITIES;
+    uint64_t counted = 0;
+    double us_per_count, util = 0;
+
+    if (n > PERIODIC_MAX_TASKS) n = PERIODIC_MAX_TASKS;
+    fprintf(f, "EmbeddedRTOSSimulator schedulability analysis after %lu ticks\n", (unsigned long)now);
+    // The counter's rate is not known here: calibrate it against the ticks.
+    // All tasks together (idle included) have run for the whole run.
+    for (UBaseType_t i = 0; i < nstatus; ++i) counted += status[i].ulRunTimeCounter;
+    if (nstatus == 0 || counted == 0 || now == 0) {
+        fprintf(f, "No run-time counter data (%lu tasks, counter total %llu): nothing to analyse\n",
+                (unsigned long)uxTaskGetNumberOfTasks(), (unsigned long long)counted);
+        return;
+    }
+    us_per_count = (double)ticks_us(now) / (double)counted;
+    fprintf(f, "Run-time counter: %.3f counts per tick\n", (double)counted / now);
+    if (g_sim_config.time_scale != 1 || g_sim_config.host_sleep) {
+        fprintf(f, "WARNING: calibration assumes the counter runs through idle time; "
+                   "for exact figures run with --time-scale=1 --busy-idle\n");
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        TickType_t send, receive;
+        size_t k = periodic_exec_samples(&pt[i], samples, PERIODIC_EXEC_SAMPLES);
+        const struct task_info *info = task_scheduler_find_task(pt[i].handle);
+        qsort(samples, k, sizeof(samples[0]), cmp_u32);
+        t[i].name = pt[i].name;
+        t[i].sporadic = pt[i].sporadic;
+        t[i].prio = info ? info->priority : 0;
+        t[i].jobs = pt[i].exec_jobs;
+        t[i].t = ticks_us(pt[i].period ? pt[i].period : 1);
+        t[i].d = ticks_us(pt[i].deadline);
+        t[i].c = counts_us(pt[i].exec_max, us_per_count);
+        t[i].c50 = counts_us(percentile(samples, k, 50), us_per_count);
+        t[i].c90 = counts_us(percentile(samples, k, 90), us_per_count);
+        t[i].c99 = counts_us(percentile(samples, k, 99), us_per_count);
+        // A sporadic task's receive is its release, not blocking
+        queue_stats_task_blocking(uxTaskGetTaskNumber(pt[i].handle), &send, &receive);
+        t[i].b = ticks_us(send) + (pt[i].sporadic ? 0 : ticks_us(receive));
+        if (t[i].prio < lowest) lowest = t[i].prio;
+        util += (double)t[i].c / (double)t[i].t;
+    }
+
+    fprintf(f, "Execution time per job (us; percentiles over the last %u jobs, max over the run):\n",
+            (unsigned)PERIODIC_EXEC_SAMPLES);
+    fprintf(f, "  %-12s %-8s %7s %9s %9s %9s %9s\n", "task", "kind", "jobs", "p50", "p90", "p99", "max");
+    for (size_t i = 0; i < n; ++i) {
+        fprintf(f, "  %-12s %-8s %7u %9llu %9llu %9llu %9llu\n", t[i].name, t[i].sporadic ? "sporadic" : "periodic",
+                (unsigned)t[i].jobs, (unsigned long long)t[i].c50, (unsigned long long)t[i].c90,
+                (unsigned long long)t[i].c99, (unsigned long long)t[i].c);
+    }
+
+    fprintf(f, "Response-time analysis, current priorities (C = max, B = longest blocked queue/semaphore wait):\n");
+    write_rta(f, t, n, 0);
+    write_headroom(f, t, n, 0);
+    fprintf(f, "  Utilization %.4f\n", util);
+    for (size_t i = 0; i < ntasks; ++i) {
+        int analysed = 0;
+        for (size_t j = 0; j < n; ++j) analysed |= pt[j].handle == tasks[i].handle;
+        if (!analysed && tasks[i].priority >= lowest) {
+            fprintf(f, "  Not analysed: %s (priority %u) is not a periodic task; its interference is not included\n",
+                    tasks[i].name, (unsigned)tasks[i].priority);
+        }
+    }
+
+    assign_rate_monotonic(t, n, order);
+    fprintf(f, "Suggested rate-monotonic order (shorter period first, ties by deadline):\n");
+    for (size_t i = 0; i < n; ++i) {
+        fprintf(f, "  %-12s priority %u -> %u%s\n", order[i]->name, (unsigned)order[i]->prio,
+                (unsigned)order[i]->rm_prio, order[i]->prio == order[i]->rm_prio ? "" : "  (change)");
+    }
+    fprintf(f, "Response-time analysis, rate-monotonic priorities (B as measured under the current ones):\n");
+    write_rta(f, t, n, 1);
+    write_headroom(f, t, n, 1);
+}
+
+static void sched_analysis_at_exit(void) {
+    FILE *f = fopen(report_path, "w");
+    if (!f) {
+        printf("[SchedAnalysis] Cannot write %s\n", report_path);
+        return;
+    }
+    sched_analysis_write(f);
+    fclose(f);
+    printf("[SchedAnalysis] Report written to %s\n", report_path);
+}
+
+void sched_analysis_enable(const char *path) {
+    report_path = path ? path : SCHED_ANALYSIS_DEFAULT_PATH;
+    atexit(sched_analysis_at_exit);
+    printf("[SchedAnalysis] Response-time analysis report at exit: %s\n", report_path);
+}
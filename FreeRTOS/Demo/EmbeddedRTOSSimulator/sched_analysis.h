@@ -0,0 +1,23 @@
+#ifndef SCHED_ANALYSIS_H
+#define SCHED_ANALYSIS_H
+
+#include <stdio.h>
+
+#define SCHED_ANALYSIS_DEFAULT_PATH "sched_analysis.txt"
+
+// Schedulability analysis (--sched-analysis). Takes the per-job execution
+// times measured by periodic.c (WCET = longest observed job), the declared
+// periods and deadlines, and per task the longest blocked queue/semaphore
+// wait from queue_stats, and runs fixed-priority preemptive response-time
+// analysis:
+//
+//   R = C + B + sum over tasks j of equal or higher priority: ceil(R / Tj) * Cj
+//
+// iterated to a fixed point. The report at exit gives each task's worst-case
+// response time and slack, the rate-monotonic priority order with its own
+// analysis, and how far execution times (or rates) can grow before a
+// deadline is missed.
+void sched_analysis_enable(const char *path);
+void sched_analysis_write(FILE *f);
+
+#endif // SCHED_ANALYSIS_H
@@ -0,0 +1,209 @@
+#include "sensor_codec.h"
+#include <string.h>
+
+#define REC_KEY     0
+#define REC_DELTA   1
+#define REC_RUN     2
+#define REC_KIND(head) ((uint32_t)(head) & 3)
+
+#define VARINT_MAX_SHIFT 35 // Five bytes: every field here fits in 34 bits
+
+static uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static int32_t unzigzag(uint32_t v) {
+    return (int32_t)((v >> 1) ^ (0u - (v & 1)));
+}
+
+// --- Encoder ---
+
+void sensor_encoder_init(struct sensor_encoder *e, uint32_t reset_interval, int rle) {
+    memset(e, 0, sizeof(*e));
+    e->reset_interval = reset_interval;
+    e->rle = rle;
+}
+
+void sensor_encoder_reset(struct sensor_encoder *e) {
+    e->keyed = 0;
+}
+
+static void stage_varint(struct sensor_encoder *e, uint64_t v) {
+    while (v >= 0x80) {
+        e->stage[e->stage_len++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    e->stage[e->stage_len++] = (uint8_t)v;
+}
+
+static void stage_run(struct sensor_encoder *e) {
+    if (e->run) {
+        stage_varint(e, (uint64_t)e->run << 2 | REC_RUN);
+        e->run = 0;
+    }
+}
+
+// Only called with an empty stage, so at most a RUN plus one record is staged
+static void stage_sample(struct sensor_encoder *e, const sensor_msg_t *s) {
+    uint32_t value = (uint32_t)s->sensor_value;
+    if (!e->keyed || (e->reset_interval && e->since_key >= e->reset_interval)) {
+        stage_run(e);
+        stage_varint(e, (uint64_t)zigzag((int32_t)value) << 2 | REC_KEY);
+        stage_varint(e, s->timestamp);
+        e->keyed = 1;
+        e->since_key = 0;
+        e->prev_dt = 0;
+        e->have_delta = 0;
+    } else {
+        uint32_t dt = s->timestamp - e->prev_ts;
+        uint64_t head = (uint64_t)zigzag((int32_t)(value - e->prev_value)) << 2 | REC_DELTA;
+        uint32_t ddt = zigzag((int32_t)(dt - e->prev_dt));
+        if (e->rle && e->have_delta && head == e->last_delta && ddt == e->last_ddt && e->run < UINT32_MAX) {
+            e->run++;
+        } else {
+            stage_run(e);
+            stage_varint(e, head);
+            stage_varint(e, ddt);
+            e->last_delta = head;
+            e->last_ddt = ddt;
+            e->have_delta = 1;
+        }
+        e->prev_dt = dt;
+    }
+    e->prev_value = value;
+    e->prev_ts = s->timestamp;
+    e->since_key++;
+    e->samples++;
+}
+
+static size_t drain_stage(struct sensor_encoder *e, uint8_t *out, size_t cap) {
+    size_t n = (size_t)(e->stage_len - e->stage_off);
+    if (n > cap) n = cap;
+    memcpy(out, e->stage + e->stage_off, n);
+    e->stage_off += (uint8_t)n;
+    if (e->stage_off == e->stage_len) {
+        e->stage_off = e->stage_len = 0;
+    }
+    e->bytes += n;
+    return n;
+}
+
+size_t sensor_encode(struct sensor_encoder *e, const sensor_msg_t *in, size_t n, size_t *taken,
+                     uint8_t *out, size_t cap) {
+    size_t written = drain_stage(e, out, cap);
+    size_t i = 0;
+    while (i < n && e->stage_len == 0 && written < cap) {
+        stage_sample(e, &in[i++]);
+        written += drain_stage(e, out + written, cap - written);
+    }
+    *taken = i;
+    return written;
+}
+
+size_t sensor_encoder_flush(struct sensor_encoder *e, uint8_t *out, size_t cap) {
+    size_t written = drain_stage(e, out, cap);
+    if (e->stage_len == 0) {
+        // A staged record always ends a run, so the run can only be pending with an empty stage
+        stage_run(e);
+        written += drain_stage(e, out + written, cap - written);
+    }
+    return written;
+}
+
+size_t sensor_encoder_pending(const struct sensor_encoder *e) {
+    return (size_t)(e->stage_len - e->stage_off) + (e->run ? 1 : 0);
+}
+
+// --- Decoder ---
+
+void sensor_decoder_init(struct sensor_decoder *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+void sensor_decoder_resync(struct sensor_decoder *d) {
+    d->synced = 0;
+    d->run_left = 0;
+    d->acc = 0;
+    d->shift = 0;
+    d->nfields = 0;
+}
+
+static void decoder_step(struct sensor_decoder *d, uint32_t dv, uint32_t ddt, sensor_msg_t *out) {
+    d->prev_dt += ddt;
+    d->prev_ts += d->prev_dt;
+    d->prev_value += dv;
+    out->sensor_value = (int)(int32_t)d->prev_value;
+    out->timestamp = d->prev_ts;
+}
+
+// Applies a complete record; returns the samples written to out (0 or 1)
+static size_t decoder_apply(struct sensor_decoder *d, sensor_msg_t *out) {
+    uint64_t head = d->fields[0];
+    switch (REC_KIND(head)) {
+        case REC_KEY:
+            d->prev_value = (uint32_t)unzigzag((uint32_t)(head >> 2));
+            d->prev_ts = (uint32_t)d->fields[1];
+            d->prev_dt = 0;
+            d->have_delta = 0;
+            d->synced = 1;
+            out->sensor_value = (int)(int32_t)d->prev_value;
+            out->timestamp = d->prev_ts;
+            return 1;
+        case REC_DELTA:
+            if (!d->synced) {
+                d->skipped++;
+                return 0;
+            }
+            d->last_dv = (uint32_t)unzigzag((uint32_t)(head >> 2));
+            d->last_ddt = (uint32_t)unzigzag((uint32_t)d->fields[1]);
+            d->have_delta = 1;
+            decoder_step(d, d->last_dv, d->last_ddt, out);
+            return 1;
+        case REC_RUN:
+            if (!d->synced) {
+                d->skipped += (uint32_t)(head >> 2);
+            } else if (!d->have_delta) {
+                d->errors++;
+                sensor_decoder_resync(d);
+            } else {
+                d->run_left = (uint32_t)(head >> 2);
+            }
+            return 0;
+        default:
+            d->errors++;
+            sensor_decoder_resync(d);
+            return 0;
+    }
+}
+
+size_t sensor_decode(struct sensor_decoder *d, const uint8_t *in, size_t len, size_t *used,
+                     sensor_msg_t *out, size_t max) {
+    size_t i = 0, k = 0;
+    for (;;) {
+        while (d->run_left && k < max) {
+            decoder_step(d, d->last_dv, d->last_ddt, &out[k++]);
+            d->run_left--;
+        }
+        if (k >= max || i >= len) break;
+        uint8_t b = in[i++];
+        d->acc |= (uint64_t)(b & 0x7F) << d->shift;
+        if (b & 0x80) {
+            d->shift += 7;
+            if (d->shift >= VARINT_MAX_SHIFT) {
+                d->errors++;
+                sensor_decoder_resync(d);
+            }
+            continue;
+        }
+        d->fields[d->nfields++] = d->acc;
+        d->acc = 0;
+        d->shift = 0;
+        // RUN is one field, KEY and DELTA two
+        if (REC_KIND(d->fields[0]) == REC_RUN || d->nfields == 2) {
+            d->nfields = 0;
+            k += decoder_apply(d, &out[k]);
+        }
+    }
+    *used = i;
+    return k;
+}
@@ -0,0 +1,76 @@
+#ifndef SENSOR_CODEC_H
+#define SENSOR_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "task_scheduler.h"
+
+// Streaming compression for sensor_msg_t sequences on the links. Each record
+// starts with a varint head whose low two bits give its kind:
+//
+//   KEY    head = zigzag(value) << 2 | 0, then varint timestamp
+//   DELTA  head = zigzag(value - prev value) << 2 | 1,
+//          then zigzag((ts - prev ts) - prev interval)
+//   RUN    head = n << 2 | 2: the previous DELTA repeats n more times (RLE only)
+//
+// A slowly moving value sampled at a fixed period costs two bytes per sample
+// (one with RLE when it holds still) instead of eight. A KEY every
+// reset_interval samples restarts the prediction, so a decoder that lost
+// input (sensor_decoder_resync) is back in step by the next KEY.
+#define SENSOR_CODEC_DEFAULT_RESET      16
+#define SENSOR_CODEC_MAX_SAMPLE_BYTES   15  // RUN + KEY: the most one sample can emit
+#define SENSOR_CODEC_STAGE_SIZE         16
+
+struct sensor_encoder {
+    uint32_t reset_interval;    // Samples between KEYs (0 = first sample only)
+    int rle;                    // Collapse repeated DELTAs into RUNs
+    uint32_t since_key;         // Samples since the last KEY
+    int keyed;                  // A KEY has been emitted since init/reset
+    uint32_t prev_value, prev_ts, prev_dt;
+    uint64_t last_delta;        // Head of the last DELTA and its interval term,
+    uint32_t last_ddt;          // what a RUN repeats
+    int have_delta;
+    uint32_t run;               // Repeats not yet emitted
+    uint8_t stage[SENSOR_CODEC_STAGE_SIZE]; // Bytes that did not fit the last segment
+    uint8_t stage_len, stage_off;
+    uint64_t samples;           // Totals, for the compression ratio
+    uint64_t bytes;
+};
+
+struct sensor_decoder {
+    int synced;                 // A KEY has been seen since init/resync
+    uint32_t prev_value, prev_ts, prev_dt;
+    uint32_t last_dv, last_ddt; // What a RUN repeats
+    int have_delta;
+    uint32_t run_left;          // RUN samples not yet written out
+    uint64_t acc;               // Record being parsed (may span input segments)
+    unsigned shift;
+    unsigned nfields;
+    uint64_t fields[2];
+    uint32_t skipped;           // Samples dropped while waiting for a KEY
+    uint32_t errors;            // Malformed records
+};
+
+void sensor_encoder_init(struct sensor_encoder *e, uint32_t reset_interval, int rle);
+// Next sample is a KEY
+void sensor_encoder_reset(struct sensor_encoder *e);
+// Encodes samples straight into out[0..cap) and stops when either runs out.
+// A record cut off at the end of out is finished by the next call, so out
+// can be successive ring-buffer segments. Returns bytes written; *taken is
+// the number of samples consumed.
+size_t sensor_encode(struct sensor_encoder *e, const sensor_msg_t *in, size_t n, size_t *taken,
+                     uint8_t *out, size_t cap);
+// Emits a pending RUN and staged bytes. Complete when sensor_encoder_pending() is 0.
+size_t sensor_encoder_flush(struct sensor_encoder *e, uint8_t *out, size_t cap);
+size_t sensor_encoder_pending(const struct sensor_encoder *e);
+
+void sensor_decoder_init(struct sensor_decoder *d);
+// Input was lost: drop the partial record and skip samples until the next KEY
+void sensor_decoder_resync(struct sensor_decoder *d);
+// Decodes from in[0..len) into out[0..max). Partial records carry over to the
+// next call, so in can be successive ring-buffer segments. Returns samples
+// written; *used is the number of input bytes consumed.
+size_t sensor_decode(struct sensor_decoder *d, const uint8_t *in, size_t len, size_t *used,
+                     sensor_msg_t *out, size_t max);
+
+#endif // SENSOR_CODEC_H
@@ -0,0 +1,54 @@
+#ifndef SIM_ALLOC_H
+#define SIM_ALLOC_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "semphr.h"
+#include "event_groups.h"
+#include "task_scheduler.h"
+
+// Kernel object creation that follows the allocation mode in FreeRTOSConfig.h.
+// With configSUPPORT_STATIC_ALLOCATION each call site reserves its own static
+// storage (stack + TCB, queue storage area + control block, ...), so sizes must
+// be compile-time constants. Otherwise objects come from the FreeRTOS heap.
+// Tasks are also recorded in the task_scheduler registry with their declared
+// stack depth. GCC statement expressions, like the rest of the POSIX build.
+
+#if configSUPPORT_STATIC_ALLOCATION
+
+#define SIM_TASK_CREATE(fn, name, depth, param, prio) ({ \
+    static StackType_t sim_stack_[(depth)]; \
+    static StaticTask_t sim_tcb_; \
+    TaskHandle_t sim_handle_ = xTaskCreateStatic((fn), (name), (depth), (param), (prio), sim_stack_, &sim_tcb_); \
+    task_scheduler_register_task(sim_handle_, (name), (depth), (prio)); \
+    sim_handle_; })
+
+#define SIM_QUEUE_CREATE(length, item_size) ({ \
+    static uint8_t sim_storage_[(length) * (item_size)]; \
+    static StaticQueue_t sim_queue_; \
+    xQueueCreateStatic((length), (item_size), sim_storage_, &sim_queue_); })
+
+#define SIM_SEMAPHORE_CREATE_BINARY() ({ \
+    static StaticSemaphore_t sim_sem_; \
+    xSemaphoreCreateBinaryStatic(&sim_sem_); })
+
+#define SIM_EVENT_GROUP_CREATE() ({ \
+    static StaticEventGroup_t sim_group_; \
+    xEventGroupCreateStatic(&sim_group_); })
+
+#else
+
+#define SIM_TASK_CREATE(fn, name, depth, param, prio) ({ \
+    TaskHandle_t sim_handle_ = NULL; \
+    xTaskCreate((fn), (name), (depth), (param), (prio), &sim_handle_); \
+    task_scheduler_register_task(sim_handle_, (name), (depth), (prio)); \
+    sim_handle_; })
+
+#define SIM_QUEUE_CREATE(length, item_size)  xQueueCreate((length), (item_size))
+#define SIM_SEMAPHORE_CREATE_BINARY()        xSemaphoreCreateBinary()
+#define SIM_EVENT_GROUP_CREATE()             xEventGroupCreate()
+
+#endif
+
+#endif // SIM_ALLOC_H
@@ -0,0 +1,347 @@
+#include "sim_config.h"
+#include "sim_time.h"
+#include "replay.h"
+#include "mem_profile.h"
+#include "telemetry.h"
+#include "stats_shm.h"
+#include "metrics_log.h"
+#include "fleet.h"
+#include "sensor_codec.h"
+#include "frame.h"
+#include "periodic.h"
+#include "sched_analysis.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+
+struct sim_config g_sim_config = {
+    .time_scale = SIM_TIME_SCALE_REAL,
+    .run_for_ms = 0,
+    .host_sleep = 1,
+    .fatal_park = 0,
+    .replay_path = NULL,
+    .replay_rate = REPLAY_RATE_REAL,
+    .replay_loop = 0,
+    .mem_profile = 0,
+    .mem_profile_path = NULL,
+    .mem_margin = MEM_PROFILE_DEFAULT_MARGIN,
+    .telemetry = 1,
+    .stats_host = TELEMETRY_DEFAULT_HOST,
+    .stats_port = TELEMETRY_DEFAULT_PORT,
+    .stats_interval_ms = TELEMETRY_DEFAULT_INTERVAL_MS,
+    .stats_batch = TELEMETRY_DEFAULT_BATCH,
+    .source_id = 0,
+    .shm_name = NULL,
+    .shm_interval_ms = STATS_SHM_DEFAULT_INTERVAL_MS,
+    .metrics_log = 0,
+    .metrics_log_path = NULL,
+    .metrics_interval_ms = METRICS_LOG_DEFAULT_INTERVAL_MS,
+    .checkpoint_path = NULL,
+    .restore_path = NULL,
+    .seed = 1,
+    .fleet_size = 0,
+    .fleet_dir = FLEET_DEFAULT_DIR,
+    .fleet_config = NULL,
+    .fleet_interval_ms = FLEET_DEFAULT_INTERVAL_MS,
+    .link_batch = 1,
+    .link_reset = SENSOR_CODEC_DEFAULT_RESET,
+    .link_rle = 0,
+    .jitter_alarm_pct = PERIODIC_DEFAULT_JITTER_ALARM,
+    .response_alarm_pct = PERIODIC_DEFAULT_RESPONSE_ALARM,
+    .sched_analysis = 0,
+    .sched_analysis_path = NULL,
+};
+
+void sim_config_usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --time-scale=N|max  Virtual time: advance N ticks per host tick while idle,\n");
+    printf("                      or jump straight to the next wake-up with 'max' (default 1)\n");
+    printf("  --run-for=SECONDS   Exit after SECONDS of simulated time\n");
+    printf("  --busy-idle         Spin in the idle task instead of sleeping the host\n");
+    printf("  --on-fatal=exit|park On stack overflow/malloc failure: exit (default) or\n");
+    printf("                      park at 0%% CPU until SIGINT, for a debugger\n");
+    printf("  --replay=FILE       Inject UART/SPI/PCIe/sensor stimuli from a trace file\n");
+    printf("  --replay-rate=N|max Replay N times faster than recorded, or as fast as possible\n");
+    printf("  --replay-loop       Restart the trace when it ends\n");
+    printf("  --mem-profile[=FILE] Write stack/queue sizing recommendations at exit\n");
+    printf("                      (default %s)\n", MEM_PROFILE_DEFAULT_PATH);
+    printf("  --mem-margin=PCT    Safety margin over observed peaks (default %u)\n", MEM_PROFILE_DEFAULT_MARGIN);
+    printf("  --stats-host=HOST   Telemetry destination (default %s)\n", TELEMETRY_DEFAULT_HOST);
+    printf("  --stats-port=PORT   Telemetry UDP port (default %u)\n", TELEMETRY_DEFAULT_PORT);
+    printf("  --stats-interval=MS Telemetry sampling period (default %u)\n", TELEMETRY_DEFAULT_INTERVAL_MS);
+    printf("  --stats-batch=N     Samples per telemetry datagram (default %u)\n", TELEMETRY_DEFAULT_BATCH);
+    printf("  --source-id=N       Telemetry source id, 1-65535 (default: process id)\n");
+    printf("  --no-telemetry      Do not send telemetry\n");
+    printf("  --shm[=NAME]        Publish live stats in shared memory (default %s)\n", STATS_SHM_DEFAULT_NAME);
+    printf("  --shm-interval=MS   Shared-memory publishing period (default %u)\n", STATS_SHM_DEFAULT_INTERVAL_MS);
+    printf("  --metrics-log[=FILE] Append samples to a columnar binary log (default %s)\n", METRICS_LOG_DEFAULT_PATH);
+    printf("  --metrics-interval=MS Metrics log sampling period (default %u)\n", METRICS_LOG_DEFAULT_INTERVAL_MS);
+    printf("  --checkpoint=FILE   Save board/UART/SPI/PCIe/LRU state to FILE at exit\n");
+    printf("  --restore=FILE      Start from a --checkpoint snapshot, skipping bring-up\n");
+    printf("  --seed=N            Sensor workload random seed (default 1)\n");
+    printf("  --fleet=N           Fork N instances pinned across host CPUs, with a combined report\n");
+    printf("  --fleet-dir=DIR     Instance working directories and report (default %s)\n", FLEET_DEFAULT_DIR);
+    printf("  --fleet-config=FILE Extra options per instance, one line each (cycled)\n");
+    printf("  --fleet-interval=MS Combined report period (default %u)\n", FLEET_DEFAULT_INTERVAL_MS);
+    printf("  --link-batch=N      Delta/varint-compress N sensor samples per link frame,\n");
+    printf("                      1-%u (default 1: one uncompressed sample per frame)\n", FRAME_MAX_BATCH);
+    printf("  --link-reset=N      Restart the codec prediction every N samples (default %u)\n", SENSOR_CODEC_DEFAULT_RESET);
+    printf("  --link-rle          Run-length encode repeated sample deltas\n");
+    printf("  --jitter-alarm=PCT  Alarm when a periodic task starts later than PCT%% of its\n");
+    printf("                      period after its release, 0 = off (default %u)\n", PERIODIC_DEFAULT_JITTER_ALARM);
+    printf("  --response-alarm=PCT Alarm when a job takes PCT%% of its deadline, 0 = off (default %u)\n", PERIODIC_DEFAULT_RESPONSE_ALARM);
+    printf("  --sched-analysis[=FILE] Write a response-time analysis of the periodic tasks at\n");
+    printf("                      exit (default %s)\n", SCHED_ANALYSIS_DEFAULT_PATH);
+    printf("  --help              Show this help\n");
+}
+
+static int parse_u32(const char *s, uint32_t *out) {
+    char *end;
+    unsigned long v = strtoul(s, &end, 10);
+    if (*s == '\0' || *end != '\0' || v > UINT32_MAX) return -1;
+    *out = (uint32_t)v;
+    return 0;
+}
+
+int sim_config_parse(int argc, char **argv) {
+    static const struct option options[] = {
+        { "time-scale",  required_argument, NULL, 't' },
+        { "run-for",     required_argument, NULL, 'r' },
+        { "busy-idle",   no_argument,       NULL, 'B' },
+        { "on-fatal",    required_argument, NULL, 'F' },
+        { "replay",      required_argument, NULL, 'p' },
+        { "replay-rate", required_argument, NULL, 'R' },
+        { "replay-loop", no_argument,       NULL, 'L' },
+        { "mem-profile", optional_argument, NULL, 'm' },
+        { "mem-margin",  required_argument, NULL, 'M' },
+        { "stats-host",  required_argument, NULL, 'H' },
+        { "stats-port",  required_argument, NULL, 'P' },
+        { "stats-interval", required_argument, NULL, 'i' },
+        { "stats-batch", required_argument, NULL, 'b' },
+        { "source-id",   required_argument, NULL, 's' },
+        { "no-telemetry", no_argument,      NULL, 'T' },
+        { "shm",         optional_argument, NULL, 'S' },
+        { "shm-interval", required_argument, NULL, 'I' },
+        { "metrics-log", optional_argument, NULL, 'g' },
+        { "metrics-interval", required_argument, NULL, 'G' },
+        { "checkpoint",  required_argument, NULL, 'c' },
+        { "restore",     required_argument, NULL, 'x' },
+        { "seed",        required_argument, NULL, 'e' },
+        { "fleet",       required_argument, NULL, 'f' },
+        { "fleet-dir",   required_argument, NULL, 'D' },
+        { "fleet-config", required_argument, NULL, 'C' },
+        { "fleet-interval", required_argument, NULL, 'J' },
+        { "link-batch",  required_argument, NULL, 'k' },
+        { "link-reset",  required_argument, NULL, 'K' },
+        { "link-rle",    no_argument,       NULL, 'Q' },
+        { "jitter-alarm", required_argument, NULL, 'j' },
+        { "response-alarm", required_argument, NULL, 'a' },
+        { "sched-analysis", optional_argument, NULL, 'A' },
+        { "help",        no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    int opt;
+    uint32_t v;
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+        switch (opt) {
+            case 't':
+                if (strcmp(optarg, "max") == 0) {
+                    g_sim_config.time_scale = SIM_TIME_SCALE_MAX;
+                } else if (parse_u32(optarg, &v) == 0 && v >= 1) {
+                    g_sim_config.time_scale = v;
+                } else {
+                    printf("[Config] Invalid --time-scale: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'r':
+                if (parse_u32(optarg, &v) != 0 || v > UINT32_MAX / 1000) {
+                    printf("[Config] Invalid --run-for: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.run_for_ms = v * 1000;
+                break;
+            case 'B':
+                g_sim_config.host_sleep = 0;
+                break;
+            case 'F':
+                if (strcmp(optarg, "park") == 0) {
+                    g_sim_config.fatal_park = 1;
+                } else if (strcmp(optarg, "exit") == 0) {
+                    g_sim_config.fatal_park = 0;
+                } else {
+                    printf("[Config] Invalid --on-fatal: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'p':
+                g_sim_config.replay_path = optarg;
+                break;
+            case 'R':
+                if (strcmp(optarg, "max") == 0) {
+                    g_sim_config.replay_rate = REPLAY_RATE_MAX;
+                } else if (parse_u32(optarg, &v) == 0 && v >= 1) {
+                    g_sim_config.replay_rate = v;
+                } else {
+                    printf("[Config] Invalid --replay-rate: %s\n", optarg);
+                    return -1;
+                }
+                break;
+            case 'L':
+                g_sim_config.replay_loop = 1;
+                break;
+            case 'm':
+                g_sim_config.mem_profile = 1;
+                g_sim_config.mem_profile_path = optarg;
+                break;
+            case 'M':
+                if (parse_u32(optarg, &v) != 0 || v > 1000) {
+                    printf("[Config] Invalid --mem-margin: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.mem_margin = v;
+                break;
+            case 'H':
+                g_sim_config.stats_host = optarg;
+                break;
+            case 'P':
+                if (parse_u32(optarg, &v) != 0 || v == 0 || v > 65535) {
+                    printf("[Config] Invalid --stats-port: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.stats_port = (uint16_t)v;
+                break;
+            case 'i':
+                if (parse_u32(optarg, &v) != 0 || v == 0) {
+                    printf("[Config] Invalid --stats-interval: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.stats_interval_ms = v;
+                break;
+            case 'b':
+                if (parse_u32(optarg, &v) != 0 || v == 0 || v > 255) {
+                    printf("[Config] Invalid --stats-batch: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.stats_batch = v;
+                break;
+            case 's':
+                if (parse_u32(optarg, &v) != 0 || v == 0 || v > 65535) {
+                    printf("[Config] Invalid --source-id: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.source_id = (uint16_t)v;
+                break;
+            case 'T':
+                g_sim_config.telemetry = 0;
+                break;
+            case 'S':
+                if (optarg && optarg[0] != '/') {
+                    printf("[Config] Invalid --shm: %s (names start with '/')\n", optarg);
+                    return -1;
+                }
+                g_sim_config.shm_name = optarg ? optarg : STATS_SHM_DEFAULT_NAME;
+                break;
+            case 'I':
+                if (parse_u32(optarg, &v) != 0 || v == 0) {
+                    printf("[Config] Invalid --shm-interval: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.shm_interval_ms = v;
+                break;
+            case 'g':
+                g_sim_config.metrics_log = 1;
+                g_sim_config.metrics_log_path = optarg;
+                break;
+            case 'G':
+                if (parse_u32(optarg, &v) != 0 || v == 0) {
+                    printf("[Config] Invalid --metrics-interval: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.metrics_interval_ms = v;
+                break;
+            case 'c':
+                g_sim_config.checkpoint_path = optarg;
+                break;
+            case 'x':
+                g_sim_config.restore_path = optarg;
+                break;
+            case 'e':
+                if (parse_u32(optarg, &v) != 0) {
+                    printf("[Config] Invalid --seed: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.seed = v;
+                break;
+            case 'f':
+                if (parse_u32(optarg, &v) != 0 || v == 0 || v > FLEET_MAX_INSTANCES) {
+                    printf("[Config] Invalid --fleet: %s (1-%u)\n", optarg, (unsigned)FLEET_MAX_INSTANCES);
+                    return -1;
+                }
+                g_sim_config.fleet_size = v;
+                break;
+            case 'D':
+                g_sim_config.fleet_dir = optarg;
+                break;
+            case 'C':
+                g_sim_config.fleet_config = optarg;
+                break;
+            case 'J':
+                if (parse_u32(optarg, &v) != 0 || v == 0) {
+                    printf("[Config] Invalid --fleet-interval: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.fleet_interval_ms = v;
+                break;
+            case 'k':
+                if (parse_u32(optarg, &v) != 0 || v == 0 || v > FRAME_MAX_BATCH) {
+                    printf("[Config] Invalid --link-batch: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.link_batch = v;
+                break;
+            case 'K':
+                if (parse_u32(optarg, &v) != 0) {
+                    printf("[Config] Invalid --link-reset: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.link_reset = v;
+                break;
+            case 'Q':
+                g_sim_config.link_rle = 1;
+                break;
+            case 'j':
+                if (parse_u32(optarg, &v) != 0 || v > 100) {
+                    printf("[Config] Invalid --jitter-alarm: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.jitter_alarm_pct = v;
+                break;
+            case 'a':
+                if (parse_u32(optarg, &v) != 0 || v > 100) {
+                    printf("[Config] Invalid --response-alarm: %s\n", optarg);
+                    return -1;
+                }
+                g_sim_config.response_alarm_pct = v;
+                break;
+            case 'A':
+                g_sim_config.sched_analysis = 1;
+                g_sim_config.sched_analysis_path = optarg;
+                break;
+            default:
+                sim_config_usage(argv[0]);
+                return -1;
+        }
+    }
+    if (optind < argc) {
+        sim_config_usage(argv[0]);
+        return -1;
+    }
+    if (g_sim_config.source_id == 0) {
+        // Distinct per process, so several simulators can share one receiver
+        g_sim_config.source_id = (uint16_t)(getpid() % 65535 + 1);
+    }
+    return 0;
+}
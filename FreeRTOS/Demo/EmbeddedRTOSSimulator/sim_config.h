@@ -0,0 +1,51 @@
+#ifndef SIM_CONFIG_H
+#define SIM_CONFIG_H
+
+#include <stdint.h>
+
+// Runtime configuration, filled from the command line by sim_config_parse()
+struct sim_config {
+    uint32_t time_scale;   // Virtual ticks per host tick (SIM_TIME_SCALE_*)
+    uint32_t run_for_ms;   // Stop after this much simulated time (0 = forever)
+    int host_sleep;        // Sleep the host while idle instead of spinning
+    int fatal_park;        // Fatal hooks park instead of exiting
+    const char *replay_path; // Stimulus trace to replay (NULL = none)
+    uint32_t replay_rate;  // REPLAY_RATE_* or speed-up factor
+    int replay_loop;       // Restart the trace when it ends
+    int mem_profile;       // Write a stack/queue sizing report at exit
+    const char *mem_profile_path; // Report file (NULL = MEM_PROFILE_DEFAULT_PATH)
+    uint32_t mem_margin;   // Safety margin in percent for recommended sizes
+    int telemetry;         // Send binary UDP telemetry
+    const char *stats_host; // Telemetry destination (name or address)
+    uint16_t stats_port;
+    uint32_t stats_interval_ms; // Sampling period
+    uint32_t stats_batch;  // Samples per datagram
+    uint16_t source_id;    // Identifies this instance to receivers
+    const char *shm_name;  // Live stats segment (NULL = not published)
+    uint32_t shm_interval_ms; // Publishing period
+    int metrics_log;       // Append samples to a columnar metrics file
+    const char *metrics_log_path; // NULL = METRICS_LOG_DEFAULT_PATH
+    uint32_t metrics_interval_ms; // Sampling period
+    const char *checkpoint_path; // Save device state here at exit (NULL = off)
+    const char *restore_path; // Start from this snapshot instead of bring-up
+    uint32_t seed;         // srand() seed for the sensor workload
+    uint32_t fleet_size;   // Fork this many instances (0 = single instance)
+    const char *fleet_dir; // Per-instance working directories and the report
+    const char *fleet_config; // Extra options per instance, one line each
+    uint32_t fleet_interval_ms; // Combined report period
+    uint32_t link_batch;   // Sensor samples per link frame (1 = uncompressed frames)
+    uint32_t link_reset;   // Codec KEY interval in samples (0 = first sample only)
+    int link_rle;          // Run-length encode repeated deltas
+    uint32_t jitter_alarm_pct; // Periodic tasks: release jitter alarm, % of period
+    uint32_t response_alarm_pct; // Response time alarm, % of deadline
+    int sched_analysis;    // Write a response-time analysis report at exit
+    const char *sched_analysis_path; // NULL = SCHED_ANALYSIS_DEFAULT_PATH
+};
+
+extern struct sim_config g_sim_config;
+
+// Returns 0 on success, -1 on bad arguments (usage has been printed)
+int sim_config_parse(int argc, char **argv);
+void sim_config_usage(const char *prog);
+
+#endif // SIM_CONFIG_H
@@ -0,0 +1,15 @@
+#ifndef SIM_LOG_H
+#define SIM_LOG_H
+
+#include <stdio.h>
+
+// Console logging for the device models. Building with -DSIM_QUIET compiles
+// the messages out (arguments are still type-checked) so that benchmarks
+// measure the models and not stdio.
+#ifdef SIM_QUIET
+#define SIM_LOG(...) do { if (0) printf(__VA_ARGS__); } while (0)
+#else
+#define SIM_LOG(...) printf(__VA_ARGS__)
+#endif
+
+#endif // SIM_LOG_H
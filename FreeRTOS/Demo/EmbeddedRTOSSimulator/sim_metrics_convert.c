@@ -0,0 +1,238 @@
+// EmbeddedRTOSSimulator - sim_metrics_convert.c
+// Converts a --metrics-log file to CSV or JSON, optionally limited to a tick
+// range and a set of columns, or prints min/avg/max per column.
+// Standalone host tool: links nothing from FreeRTOS or the simulator.
+#include "metrics_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+struct summary {
+    uint32_t min;
+    uint32_t max;
+    double sum;
+};
+
+static struct metrics_log_header hdr;
+static struct metrics_log_column names[METRICS_LOG_MAX_COLUMNS];
+static int fd = -1;
+static uint32_t num_blocks = 0;
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options] FILE\n", prog);
+    printf("  --format=csv|json  Output format (default csv)\n");
+    printf("  --from=TICK        First tick to include\n");
+    printf("  --to=TICK          Last tick to include\n");
+    printf("  --columns=A,B,...  Only these columns (tick is always included)\n");
+    printf("  --summary          Print min/avg/max per column instead of rows\n");
+    printf("  --list             List the columns and blocks, then exit\n");
+    printf("  --help             Show this help\n");
+}
+
+static int read_at(void *buf, size_t len, off_t off) {
+    ssize_t n = pread(fd, buf, len, off);
+    return n == (ssize_t)len ? 0 : -1;
+}
+
+static int open_log(const char *path) {
+    struct stat st;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[Convert] Cannot open %s\n", path);
+        return -1;
+    }
+    if (read_at(&hdr, sizeof(hdr), 0) != 0 || memcmp(hdr.magic, METRICS_LOG_MAGIC, sizeof(METRICS_LOG_MAGIC)) != 0) {
+        fprintf(stderr, "[Convert] %s is not a metrics log\n", path);
+        return -1;
+    }
+    if (hdr.byte_order != METRICS_LOG_BYTE_ORDER || hdr.version != METRICS_LOG_VERSION) {
+        fprintf(stderr, "[Convert] %s: unsupported version %u or byte order\n", path, (unsigned)hdr.version);
+        return -1;
+    }
+    if (hdr.num_columns == 0 || hdr.num_columns > METRICS_LOG_MAX_COLUMNS || hdr.block_rows == 0 ||
+        hdr.block_bytes != sizeof(struct metrics_log_block_header) + (uint64_t)hdr.num_columns * hdr.block_rows * 4 ||
+        read_at(names, hdr.num_columns * sizeof(names[0]), sizeof(hdr)) != 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "[Convert] %s: corrupt header\n", path);
+        return -1;
+    }
+    for (uint32_t c = 0; c < hdr.num_columns; ++c) {
+        names[c].name[METRICS_LOG_NAME_LEN - 1] = '\0';
+    }
+    // A trailing partial block (crash while writing) is ignored
+    num_blocks = st.st_size > hdr.header_size ? (uint32_t)((st.st_size - hdr.header_size) / hdr.block_bytes) : 0;
+    return 0;
+}
+
+static int read_block_header(uint32_t b, struct metrics_log_block_header *bh) {
+    if (read_at(bh, sizeof(*bh), (off_t)hdr.header_size + (off_t)b * hdr.block_bytes) != 0) return -1;
+    if (bh->magic != METRICS_LOG_BLOCK_MAGIC || bh->rows > hdr.block_rows) return -1;
+    return 0;
+}
+
+// First block that can contain `from`: ticks only grow, so binary search on last_tick
+static uint32_t find_first_block(uint32_t from) {
+    uint32_t lo = 0, hi = num_blocks;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        struct metrics_log_block_header bh;
+        if (read_block_header(mid, &bh) != 0 || bh.last_tick >= from) hi = mid;
+        else lo = mid + 1;
+    }
+    return lo;
+}
+
+static int select_columns(char *list, uint8_t *selected) {
+    memset(selected, 0, METRICS_LOG_MAX_COLUMNS);
+    selected[0] = 1;
+    if (list == NULL) {
+        memset(selected, 1, hdr.num_columns);
+        return 0;
+    }
+    for (char *tok = strtok(list, ","); tok; tok = strtok(NULL, ",")) {
+        uint32_t c;
+        for (c = 0; c < hdr.num_columns && strcmp(names[c].name, tok) != 0; ++c) {
+        }
+        if (c == hdr.num_columns) {
+            fprintf(stderr, "[Convert] Unknown column: %s (see --list)\n", tok);
+            return -1;
+        }
+        selected[c] = 1;
+    }
+    return 0;
+}
+
+static void list_log(void) {
+    struct metrics_log_block_header first, last;
+    printf("version %u, %u columns, %u rows per block, %u blocks, sampled every %u ms at %u Hz\n",
+           (unsigned)hdr.version, (unsigned)hdr.num_columns, (unsigned)hdr.block_rows, (unsigned)num_blocks,
+           (unsigned)hdr.interval_ms, (unsigned)hdr.tick_rate_hz);
+    if (num_blocks > 0 && read_block_header(0, &first) == 0 && read_block_header(num_blocks - 1, &last) == 0) {
+        printf("ticks %u .. %u\n", (unsigned)first.first_tick, (unsigned)last.last_tick);
+    }
+    for (uint32_t c = 0; c < hdr.num_columns; ++c) {
+        printf("  %s\n", names[c].name);
+    }
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        { "format",  required_argument, NULL, 'f' },
+        { "from",    required_argument, NULL, 'a' },
+        { "to",      required_argument, NULL, 'b' },
+        { "columns", required_argument, NULL, 'c' },
+        { "summary", no_argument,       NULL, 's' },
+        { "list",    no_argument,       NULL, 'l' },
+        { "help",    no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    static uint8_t selected[METRICS_LOG_MAX_COLUMNS];
+    static struct summary sums[METRICS_LOG_MAX_COLUMNS];
+    uint32_t from = 0, to = UINT32_MAX;
+    char *column_list = NULL;
+    int json = 0, summary = 0, list = 0, opt;
+    uint64_t rows_out = 0;
+    uint32_t *data;
+
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'f':
+                if (strcmp(optarg, "json") == 0) json = 1;
+                else if (strcmp(optarg, "csv") != 0) {
+                    fprintf(stderr, "[Convert] Invalid --format: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'a': from = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'b': to = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case 'c': column_list = optarg; break;
+            case 's': summary = 1; break;
+            case 'l': list = 1; break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    if (optind != argc - 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (open_log(argv[optind]) != 0) return EXIT_FAILURE;
+    if (list) {
+        list_log();
+        return EXIT_SUCCESS;
+    }
+    if (select_columns(column_list, selected) != 0) return EXIT_FAILURE;
+    data = malloc(hdr.block_bytes);
+    if (!data) return EXIT_FAILURE;
+
+    if (!summary) {
+        if (json) {
+            printf("[\n");
+        } else {
+            const char *sep = "";
+            for (uint32_t c = 0; c < hdr.num_columns; ++c) {
+                if (!selected[c]) continue;
+                printf("%s%s", sep, names[c].name);
+                sep = ",";
+            }
+            printf("\n");
+        }
+    }
+    for (uint32_t b = find_first_block(from); b < num_blocks; ++b) {
+        const struct metrics_log_block_header *bh = (const struct metrics_log_block_header *)data;
+        const uint32_t *cols = data + sizeof(*bh) / sizeof(uint32_t);
+        if (read_at(data, hdr.block_bytes, (off_t)hdr.header_size + (off_t)b * hdr.block_bytes) != 0 ||
+            bh->magic != METRICS_LOG_BLOCK_MAGIC || bh->rows > hdr.block_rows) {
+            fprintf(stderr, "[Convert] Block %u is corrupt, stopping\n", (unsigned)b);
+            break;
+        }
+        if (bh->first_tick > to) break;
+        for (uint32_t r = 0; r < bh->rows; ++r) {
+            uint32_t tick = cols[r];
+            const char *sep = "";
+            if (tick < from || tick > to) continue;
+            if (summary) {
+                for (uint32_t c = 0; c < hdr.num_columns; ++c) {
+                    uint32_t v = cols[(size_t)c * hdr.block_rows + r];
+                    if (rows_out == 0 || v < sums[c].min) sums[c].min = v;
+                    if (rows_out == 0 || v > sums[c].max) sums[c].max = v;
+                    sums[c].sum += v;
+                }
+            } else {
+                printf(json ? "%s  {" : "%s", rows_out > 0 && json ? ",\n" : "");
+                for (uint32_t c = 0; c < hdr.num_columns; ++c) {
+                    if (!selected[c]) continue;
+                    if (json) printf("%s\"%s\": %u", sep, names[c].name, (unsigned)cols[(size_t)c * hdr.block_rows + r]);
+                    else printf("%s%u", sep, (unsigned)cols[(size_t)c * hdr.block_rows + r]);
+                    sep = json ? ", " : ",";
+                }
+                printf(json ? "}" : "\n");
+            }
+            rows_out++;
+        }
+    }
+    if (summary) {
+        if (json) printf("{\n  \"rows\": %llu,\n  \"columns\": {", (unsigned long long)rows_out);
+        else printf("column,min,avg,max\n");
+        for (uint32_t c = 0, n = 0; c < hdr.num_columns; ++c) {
+            double avg = rows_out ? sums[c].sum / (double)rows_out : 0.0;
+            if (!selected[c]) continue;
+            if (json) {
+                printf("%s\n    \"%s\": {\"min\": %u, \"avg\": %.3f, \"max\": %u}", n++ ? "," : "",
+                       names[c].name, (unsigned)sums[c].min, avg, (unsigned)sums[c].max);
+            } else {
+                printf("%s,%u,%.3f,%u\n", names[c].name, (unsigned)sums[c].min, avg, (unsigned)sums[c].max);
+            }
+        }
+        if (json) printf("\n  }\n}\n");
+    } else if (json) {
+        printf("\n]\n");
+    }
+    free(data);
+    close(fd);
+    return EXIT_SUCCESS;
+}
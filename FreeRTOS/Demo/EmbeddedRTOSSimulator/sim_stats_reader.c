@@ -0,0 +1,136 @@
+// EmbeddedRTOSSimulator - sim_stats_reader.c
+// Prints the live stats segment published by `EmbeddedRTOSSimulator --shm`.
+// Standalone host tool: links nothing from FreeRTOS or the simulator.
+#include "stats_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static const char *const state_names[] = { "run", "ready", "blocked", "susp", "deleted", "invalid" };
+
+static void usage(const char *prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --name=NAME      Segment name (default %s)\n", STATS_SHM_DEFAULT_NAME);
+    printf("  --interval=MS    Print every MS milliseconds (default: print once)\n");
+    printf("  --count=N        Stop after N prints (default: forever with --interval)\n");
+    printf("  --help           Show this help\n");
+}
+
+static const struct stats_shm *attach(const char *name) {
+    struct stats_shm *shm;
+    struct stat st;
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        printf("[Reader] No segment %s (is the simulator running with --shm?)\n", name);
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(struct stats_shm)) {
+        printf("[Reader] Segment %s is too small for this reader\n", name);
+        close(fd);
+        return NULL;
+    }
+    shm = mmap(NULL, sizeof(*shm), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (shm == MAP_FAILED) {
+        printf("[Reader] Cannot map %s\n", name);
+        return NULL;
+    }
+    if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != STATS_SHM_MAGIC || shm->version != STATS_SHM_VERSION) {
+        printf("[Reader] %s: unknown layout (magic 0x%08x, version %u)\n", name, shm->magic, shm->version);
+        munmap(shm, sizeof(*shm));
+        return NULL;
+    }
+    return shm;
+}
+
+static double pct(uint32_t part, uint32_t whole) {
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+static void print_snapshot(const struct stats_shm *shm, const struct stats_shm_data *d, const struct stats_shm_data *prev) {
+    uint32_t total = prev ? d->total_run_time - prev->total_run_time : d->total_run_time;
+    uint32_t hits = prev ? d->cache_hits - prev->cache_hits : d->cache_hits;
+    uint32_t misses = prev ? d->cache_misses - prev->cache_misses : d->cache_misses;
+
+    printf("pid %d, update %llu, tick %u (%.1f s)\n", (int)shm->pid, (unsigned long long)d->update_count,
+           (unsigned)d->tick, d->tick_rate_hz ? (double)d->tick / d->tick_rate_hz : 0.0);
+    printf("  heap free %u (min %u)  cache hit %.1f%% (%u/%u)  latency avg %.2f max %u ticks\n",
+           (unsigned)d->free_heap, (unsigned)d->min_free_heap, pct(hits, hits + misses),
+           (unsigned)hits, (unsigned)(hits + misses),
+           d->latency_count ? (double)d->latency_sum / d->latency_count : 0.0, (unsigned)d->latency_max);
+    printf("  UART tx %u rx %u  SPI tx %u rx %u bytes  PCIe irqs legacy %u msi %u msix %u intc %u\n",
+           (unsigned)d->uart_tx_bytes, (unsigned)d->uart_rx_bytes, (unsigned)d->spi_tx_bytes, (unsigned)d->spi_rx_bytes,
+           (unsigned)d->pcie_irqs[0], (unsigned)d->pcie_irqs[1], (unsigned)d->pcie_irqs[2], (unsigned)d->pcie_irqs[3]);
+    printf("  %-16s %4s %-8s %7s %10s\n", "task", "prio", "state", "cpu", "stack free");
+    for (uint32_t i = 0; i < d->num_tasks && i < STATS_SHM_MAX_TASKS; ++i) {
+        const struct stats_shm_task *t = &d->tasks[i];
+        uint32_t run = t->run_time;
+        if (prev) {
+            // Rates over the last interval; match by id, tasks may come and go
+            run = 0;
+            for (uint32_t j = 0; j < prev->num_tasks && j < STATS_SHM_MAX_TASKS; ++j) {
+                if (prev->tasks[j].id == t->id) run = t->run_time - prev->tasks[j].run_time;
+            }
+        }
+        printf("  %-16s %4u %-8s %6.1f%% %10u\n", t->name, (unsigned)t->priority,
+               t->state < 6 ? state_names[t->state] : "?", pct(run, total), (unsigned)t->stack_free);
+    }
+    printf("  %-18s %9s %8s %8s %6s %6s %8s %8s\n", "queue", "wait/len", "sends", "recvs",
+           "full", "empty", "blk_tx", "blk_rx");
+    for (uint32_t i = 0; i < d->num_queues && i < STATS_SHM_MAX_QUEUES; ++i) {
+        const struct stats_shm_queue *q = &d->queues[i];
+        printf("  %-18s %4u/%-4u %8u %8u %6u %6u %8llu %8llu\n", q->name, (unsigned)q->waiting, (unsigned)q->length,
+               (unsigned)q->sends, (unsigned)q->receives, (unsigned)q->send_failures, (unsigned)q->receive_failures,
+               (unsigned long long)q->send_blocked_ticks, (unsigned long long)q->receive_blocked_ticks);
+    }
+}
+
+int main(int argc, char **argv) {
+    static const struct option options[] = {
+        { "name",     required_argument, NULL, 'n' },
+        { "interval", required_argument, NULL, 'i' },
+        { "count",    required_argument, NULL, 'c' },
+        { "help",     no_argument,       NULL, 'h' },
+        { NULL, 0, NULL, 0 }
+    };
+    const char *name = STATS_SHM_DEFAULT_NAME;
+    unsigned long interval_ms = 0, count = 0;
+    static struct stats_shm_data cur, prev;
+    const struct stats_shm *shm;
+    int opt, have_prev = 0;
+
+    while ((opt = getopt_long(argc, argv, "h", options, NULL)) != -1) {
+        switch (opt) {
+            case 'n': name = optarg; break;
+            case 'i': interval_ms = strtoul(optarg, NULL, 10); break;
+            case 'c': count = strtoul(optarg, NULL, 10); break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    shm = attach(name);
+    if (!shm) return EXIT_FAILURE;
+    if (interval_ms == 0) count = 1;
+    for (unsigned long n = 0; count == 0 || n < count; ++n) {
+        if (n > 0) {
+            struct timespec ts = { (time_t)(interval_ms / 1000), (long)(interval_ms % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+        }
+        if (stats_shm_read(shm, &cur) != 0) {
+            printf("[Reader] Snapshot kept changing, retrying\n");
+            continue;
+        }
+        print_snapshot(shm, &cur, have_prev ? &prev : NULL);
+        prev = cur;
+        have_prev = 1;
+        fflush(stdout);
+    }
+    return EXIT_SUCCESS;
+}
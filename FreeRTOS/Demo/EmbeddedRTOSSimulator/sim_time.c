@@ -0,0 +1,190 @@
+#include "sim_time.h"
+#include "task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/select.h>
+#include <sys/time.h>
+
+static uint32_t time_scale = SIM_TIME_SCALE_REAL;
+static int host_sleep = 1;
+static TickType_t run_until = 0;            // 0 = run forever
+static TickType_t last_jump_tick = 0;
+static volatile sig_atomic_t exit_requested = 0;
+static int fatal_exit = 0;
+static TaskHandle_t exit_task = NULL;       // vSimTimeTask, once it runs
+
+static void sim_time_signal_handler(int sig) {
+    (void)sig;
+    sim_time_request_exit();
+}
+
+static const struct itimerval timer_off = { { 0, 0 }, { 0, 0 } };
+
+void sim_time_init(uint32_t scale, uint32_t run_for_ms, int sleep_when_idle) {
+    struct sigaction sa = { 0 };
+    time_scale = scale;
+    host_sleep = sleep_when_idle;
+    run_until = run_for_ms ? pdMS_TO_TICKS(run_for_ms) : 0;
+    // Let Ctrl-C / SIGTERM leave through exit() so atexit() reports still run
+    sa.sa_handler = sim_time_signal_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    if (time_scale == SIM_TIME_SCALE_MAX) {
+        printf("[SimTime] Virtual time: jumping to next wake-up when idle\n");
+    } else if (time_scale != SIM_TIME_SCALE_REAL) {
+        printf("[SimTime] Virtual time: %u ticks per host tick when idle\n", (unsigned)time_scale);
+    }
+    if (!host_sleep) {
+        printf("[SimTime] Busy idle: the idle task spins instead of sleeping\n");
+    }
+    if (run_until) {
+        printf("[SimTime] Run limit: %u ms simulated time\n", (unsigned)run_for_ms);
+    }
+}
+
+void sim_time_request_exit(void) {
+    exit_requested = 1;
+}
+
+static void sim_time_check_exit(TickType_t now) {
+    if (exit_requested) {
+        printf("[SimTime] Exit requested at tick %lu\n", (unsigned long)now);
+    } else if (run_until && now >= run_until) {
+        printf("[SimTime] Run limit reached at tick %lu\n", (unsigned long)now);
+    } else {
+        return;
+    }
+    fflush(stdout);
+    exit(EXIT_SUCCESS);
+}
+
+// Sleeps the host for up to max_ticks (or until a signal) with the port's
+// periodic tick stopped, then accounts for the time slept with vTaskStepTick.
+// The Posix port drives the tick from ITIMER_REAL / SIGALRM.
+static void sim_time_host_sleep(TickType_t max_ticks) {
+    const uint64_t tick_ns = 1000000000ULL / configTICK_RATE_HZ;
+    const uint64_t cap_ns = (uint64_t)SIM_TIME_MAX_HOST_SLEEP_MS * 1000000ULL;
+    struct itimerval tick_timer;
+    struct timespec start, end, timeout;
+    sigset_t stop, saved_mask;
+    uint64_t sleep_ns = (uint64_t)max_ticks * tick_ns;
+    uint64_t slept_ns;
+    TickType_t slept;
+
+    // Hold SIGINT/SIGTERM until pselect() so a request arriving in between
+    // is not left waiting for a whole sleep
+    sigemptyset(&stop);
+    sigaddset(&stop, SIGINT);
+    sigaddset(&stop, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop, &saved_mask);
+    setitimer(ITIMER_REAL, &timer_off, &tick_timer);
+    // A tick or ISR that slipped in before the timer stopped aborts the sleep
+    if (!exit_requested && eTaskConfirmSleepModeStatus() != eAbortSleep) {
+        if (sleep_ns > cap_ns) sleep_ns = cap_ns;
+        timeout.tv_sec = (time_t)(sleep_ns / 1000000000ULL);
+        timeout.tv_nsec = (long)(sleep_ns % 1000000000ULL);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        pselect(0, NULL, NULL, NULL, &timeout, &saved_mask);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        slept_ns = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000000ULL + (uint64_t)end.tv_nsec - (uint64_t)start.tv_nsec;
+        slept = (TickType_t)(slept_ns / tick_ns);
+        if (slept > max_ticks) slept = max_ticks;
+        if (slept > 0) {
+            vTaskStepTick(slept);
+        }
+    }
+    // Resumes with the remainder of the interrupted period
+    setitimer(ITIMER_REAL, &tick_timer, NULL);
+    pthread_sigmask(SIG_SETMASK, &saved_mask, NULL);
+}
+
+// The idle hook below only sees idle periods. When the tasks never leave the
+// CPU idle, the tick hook wakes vSimTimeTask to check the limit and requests.
+void vApplicationTickHook(void) {
+    if (exit_task && (exit_requested || (run_until && xTaskGetTickCountFromISR() >= run_until))) {
+        vTaskNotifyGiveFromISR(exit_task, NULL);
+    }
+}
+
+void vSimTimeTask(void *pvParameters) {
+    exit_task = xTaskGetCurrentTaskHandle();
+    for (;;) {
+        // exit() belongs in a task, not in the tick interrupt
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        sim_time_check_exit(xTaskGetTickCount());
+    }
+}
+
+void sim_time_suppress_ticks_and_sleep(TickType_t expected_idle_ticks) {
+    TickType_t now = xTaskGetTickCount();
+    eSleepModeStatus status;
+    TickType_t jump;
+
+    sim_time_check_exit(now);
+    status = eTaskConfirmSleepModeStatus();
+    if (status == eAbortSleep) {
+        return;
+    }
+    // Wall-clock time, or nothing waiting on a timeout (only an external
+    // stimulus can wake the system, so there is no deadline to jump to)
+    if (time_scale == SIM_TIME_SCALE_REAL || status == eNoTasksWaitingTimeout) {
+        if (host_sleep) {
+            // Stop one tick short, as below, so the last tick comes from the timer
+            TickType_t max_ticks = status == eNoTasksWaitingTimeout ? portMAX_DELAY : expected_idle_ticks - 1;
+            if (run_until && max_ticks > run_until - now) {
+                max_ticks = run_until - now;
+            }
+            if (max_ticks > 0) {
+                sim_time_host_sleep(max_ticks);
+            }
+        }
+        return;
+    }
+    // Stop one tick short: the host timer delivers the final tick, so tasks
+    // are unblocked through the kernel's normal tick path, in order.
+    jump = expected_idle_ticks - 1;
+    if (time_scale != SIM_TIME_SCALE_MAX) {
+        // Partial acceleration: at most one jump of (scale - 1) per host tick
+        if (now == last_jump_tick) {
+            if (host_sleep) {
+                pause(); // Until the next host tick (SIGALRM) or an exit request
+            }
+            return;
+        }
+        if (jump > time_scale - 1) {
+            jump = time_scale - 1;
+        }
+    }
+    if (run_until && now < run_until && jump > run_until - now) {
+        jump = run_until - now;
+    }
+    if (jump > 0) {
+        vTaskStepTick(jump);
+        last_jump_tick = now + jump;
+    }
+}
+
+void sim_time_fatal(int park) {
+    fflush(stdout);
+    if (park) {
+        // No tick means no task runs again: the process sits at ~0% CPU
+        setitimer(ITIMER_REAL, &timer_off, NULL);
+        printf("[SimTime] Parked after fatal error, pid %d: attach a debugger or send SIGINT\n", (int)getpid());
+        fflush(stdout);
+        while (!exit_requested) {
+            struct timespec ts = { SIM_TIME_MAX_HOST_SLEEP_MS / 1000, (SIM_TIME_MAX_HOST_SLEEP_MS % 1000) * 1000000L };
+            nanosleep(&ts, NULL);
+        }
+    }
+    fatal_exit = 1;
+    exit(EXIT_FAILURE);
+}
+
+int sim_time_fatal_exit(void) {
+    return fatal_exit;
+}
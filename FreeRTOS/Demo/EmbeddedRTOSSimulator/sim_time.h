@@ -0,0 +1,38 @@
+#ifndef SIM_TIME_H
+#define SIM_TIME_H
+
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+// Time scale: virtual ticks per host timer tick while every task is blocked
+#define SIM_TIME_SCALE_MAX  0   // Jump straight to the next wake-up
+#define SIM_TIME_SCALE_REAL 1   // Wall-clock pacing (no acceleration)
+
+// Longest single host sleep; bounds exit latency when a signal is taken by
+// another task thread and cannot interrupt the idle thread's wait
+#define SIM_TIME_MAX_HOST_SLEEP_MS 1000
+
+// host_sleep: block the process while idle instead of spinning (see README)
+void sim_time_init(uint32_t time_scale, uint32_t run_for_ms, int host_sleep);
+
+// portSUPPRESS_TICKS_AND_SLEEP implementation (see FreeRTOSConfig.h).
+// Called by the idle task with the scheduler suspended.
+void sim_time_suppress_ticks_and_sleep(TickType_t expected_idle_ticks);
+
+// Ask the simulator to exit at the next idle point or tick. Async-signal-safe.
+void sim_time_request_exit(void);
+
+// Exits on --run-for or an exit request when the system is never idle: woken
+// from the tick hook (vApplicationTickHook, also in sim_time.c). Create at
+// TASK_PRIO_SIM_TIME; binaries without it only check while idle.
+void vSimTimeTask(void *pvParameters);
+
+// Fatal error policy for the application hooks: exit(EXIT_FAILURE) so atexit()
+// reports still run, or park with the tick stopped until SIGINT/SIGTERM so a
+// debugger can be attached. Never returns.
+void sim_time_fatal(int park) __attribute__((noreturn));
+// Non-zero once sim_time_fatal() is exiting: lets atexit() handlers skip
+// work that should only follow a clean run
+int sim_time_fatal_exit(void);
+
+#endif // SIM_TIME_H
@@ -1,5 +1,8 @@
 #include "spi.h"
 #include "board.h"
+#include "sim_alloc.h"
+#include "queue_stats.h"
+#include "sim_log.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -8,47 +11,106 @@ struct spi_state g_spi;
 void spi_init(spi_mode_t mode) {
     memset(&g_spi, 0, sizeof(g_spi));
     g_spi.mode = mode;
-    g_spi.rx_queue = xQueueCreate(SPI_BUFFER_SIZE, sizeof(char));
-    printf("[SPI] Initialized (ARMv8A emu, mode=%s, RX queue size %d).\n", mode == SPI_MODE_MASTER ? "MASTER" : "SLAVE", SPI_BUFFER_SIZE);
+    g_spi.rx_queue = SIM_QUEUE_CREATE(SPI_BUFFER_SIZE, sizeof(char));
+    queue_stats_register(g_spi.rx_queue, "spi_rx_queue", SPI_BUFFER_SIZE, sizeof(char));
+    SIM_LOG("[SPI] Initialized (ARMv8A emu, mode=%s, RX queue size %d).\n", mode == SPI_MODE_MASTER ? "MASTER" : "SLAVE", SPI_BUFFER_SIZE);
 }
 
-void spi_transfer(const char *tx, char *rx, int len) {
-    // Simulate SPI transfer: master sends, slave receives (loopback for demo)
-    for (int i = 0; i < len && tx[i] != '\0'; ++i) {
+void spi_restore(const struct spi_state *saved) {
+    g_spi = *saved;
+    g_spi.tx_tail = g_spi.tx_head; // Bytes left in TX were already shifted out
+    g_spi.rx_queue = SIM_QUEUE_CREATE(SPI_BUFFER_SIZE, sizeof(char));
+    queue_stats_register(g_spi.rx_queue, "spi_rx_queue", SPI_BUFFER_SIZE, sizeof(char));
+    // Unread RX bytes go back into the new queue, which mirrors the ring
+    for (size_t i = g_spi.rx_tail; i != g_spi.rx_head; i = (i + 1) % SPI_BUFFER_SIZE) {
+        xQueueSend(g_spi.rx_queue, &g_spi.rx_buffer[i], 0);
+    }
+}
+
+// Shifts len bytes out and loops them back; returns the bytes shifted. Each
+// byte leaves the TX ring as it is clocked out. The looped-back bytes go to
+// rx, and to the RX ring and queue only when to_ring is set (text transfers):
+// the binary path gets its bytes in rx and nothing would read them there.
+static size_t spi_shift(const uint8_t *tx, uint8_t *rx, size_t len, int to_ring) {
+    size_t i;
+    for (i = 0; i < len; ++i) {
         size_t next_tx = (g_spi.tx_head + 1) % SPI_BUFFER_SIZE;
         if (next_tx == g_spi.tx_tail) {
-            printf("[SPI] TX buffer full, dropping data.\n");
+            SIM_LOG("[SPI] TX buffer full, dropping data.\n");
             break;
         }
-        g_spi.tx_buffer[g_spi.tx_head] = tx[i];
+        g_spi.tx_buffer[g_spi.tx_head] = (char)tx[i];
         g_spi.tx_head = next_tx;
+        g_spi.tx_bytes++;
+        g_spi.tx_tail = g_spi.tx_head;
+        g_spi.rx_bytes++;
         // For demo, echo back to RX
-        size_t next_rx = (g_spi.rx_head + 1) % SPI_BUFFER_SIZE;
-        if (next_rx != g_spi.rx_tail) {
-            g_spi.rx_buffer[g_spi.rx_head] = tx[i];
-            g_spi.rx_head = next_rx;
-            xQueueSend(g_spi.rx_queue, &tx[i], 0);
+        if (to_ring) {
+            size_t next_rx = (g_spi.rx_head + 1) % SPI_BUFFER_SIZE;
+            if (next_rx != g_spi.rx_tail) {
+                g_spi.rx_buffer[g_spi.rx_head] = (char)tx[i];
+                g_spi.rx_head = next_rx;
+                xQueueSend(g_spi.rx_queue, &tx[i], 0);
+            }
         }
-        if (rx && i < len) rx[i] = tx[i];
+        if (rx) rx[i] = tx[i];
     }
-    if (rx) rx[len-1] = '\0';
     board_reg_write(BOARD_REG_SPI, 1); // Simulate SPI transfer complete
-    printf("[SPI] Transfer: TX=%s RX=%s\n", tx, rx ? rx : "");
+    return i;
 }
 
-void spi_simulate_rx_event(const char *data) {
+void spi_transfer(const char *tx, char *rx, int len) {
+    // Simulate SPI transfer: master sends, slave receives (loopback for demo)
+    spi_shift((const uint8_t *)tx, (uint8_t *)rx, strnlen(tx, (size_t)len), 1);
+    if (rx) rx[len-1] = '\0';
+    SIM_LOG("[SPI] Transfer: TX=%s RX=%s\n", tx, rx ? rx : "");
+}
+
+// The RX queue mirrors the RX ring: a byte taken from the queue frees its slot
+static int spi_rx_pop(char *ch) {
+    if (xQueueReceive(g_spi.rx_queue, ch, 0) != pdTRUE) return 0;
+    if (g_spi.rx_tail != g_spi.rx_head) {
+        g_spi.rx_tail = (g_spi.rx_tail + 1) % SPI_BUFFER_SIZE;
+    }
+    return 1;
+}
+
+size_t spi_read(void *buffer, size_t maxlen) {
+    char *out = buffer;
+    size_t n = 0;
+    while (n < maxlen && spi_rx_pop(&out[n])) {
+        n++;
+    }
+    if (n) SIM_LOG("[SPI] Read: %u bytes\n", (unsigned)n);
+    return n;
+}
+
+size_t spi_transfer_bytes(const void *tx, void *rx, size_t len) {
+    size_t n = spi_shift(tx, rx, len, 0);
+    SIM_LOG("[SPI] Transfer: %u of %u bytes\n", (unsigned)n, (unsigned)len);
+    return n;
+}
+
+size_t spi_simulate_rx_bytes(const void *data, size_t len) {
     // Simulate incoming data (from other device)
-    size_t len = strlen(data);
-    for (size_t i = 0; i < len; ++i) {
+    const char *p = data;
+    size_t i;
+    for (i = 0; i < len; ++i) {
         size_t next = (g_spi.rx_head + 1) % SPI_BUFFER_SIZE;
         if (next == g_spi.rx_tail) {
-            printf("[SPI] RX buffer full, dropping data.\n");
+            SIM_LOG("[SPI] RX buffer full, dropping data.\n");
             break;
         }
-        g_spi.rx_buffer[g_spi.rx_head] = data[i];
+        g_spi.rx_buffer[g_spi.rx_head] = p[i];
         g_spi.rx_head = next;
-        xQueueSend(g_spi.rx_queue, &data[i], 0);
+        g_spi.rx_bytes++;
+        xQueueSend(g_spi.rx_queue, &p[i], 0);
     }
     board_reg_write(BOARD_REG_SPI, 2); // Simulate RX ready
-    printf("[SPI] Simulated RX event: %s\n", data);
+    return i;
+}
+
+void spi_simulate_rx_event(const char *data) {
+    spi_simulate_rx_bytes(data, strlen(data));
+    SIM_LOG("[SPI] Simulated RX event: %s\n", data);
 }
\ No newline at end of file
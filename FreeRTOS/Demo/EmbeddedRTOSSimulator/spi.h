@@ -21,14 +21,24 @@ struct spi_state {
     char rx_buffer[SPI_BUFFER_SIZE];
     size_t rx_head, rx_tail;
     QueueHandle_t rx_queue; // For task notification
+    uint32_t tx_bytes;      // Bytes shifted out
+    uint32_t rx_bytes;      // Bytes received (loopback and external)
 };
 
 extern struct spi_state g_spi;
 
 void spi_init(spi_mode_t mode);
+// Warm start: load mode, buffers and counters without bring-up (checkpoint.c)
+void spi_restore(const struct spi_state *saved);
 void spi_transfer(const char *tx, char *rx, int len);
+// Binary-safe transfer (link frames): all len bytes, NUL included; returns bytes shifted
+size_t spi_transfer_bytes(const void *tx, void *rx, size_t len);
+// Drains bytes received from the other device (RX ring); never blocks
+size_t spi_read(void *buffer, size_t maxlen);
 
 // Simulate SPI RX event (data received from other device)
 void spi_simulate_rx_event(const char *data);
+// Same for binary data (replay): all len bytes, NUL included; returns bytes accepted
+size_t spi_simulate_rx_bytes(const void *data, size_t len);
 
 #endif // SPI_H
\ No newline at end of file
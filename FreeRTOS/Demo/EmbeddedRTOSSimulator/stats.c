@@ -0,0 +1,59 @@
+#include "stats.h"
+#include "uart.h"
+#include "spi.h"
+#include "pci.h"
+#include "lru_cache.h"
+#include <string.h>
+
+static uint32_t latency_count = 0;
+static uint32_t latency_sum = 0;
+static uint32_t latency_max = 0;
+
+void stats_record_latency(TickType_t ticks) {
+    latency_count++;
+    latency_sum += ticks;
+    if (ticks > latency_max) latency_max = ticks;
+}
+
+void stats_collect(struct sim_stats *out) {
+    static TaskStatus_t status[SIM_MAX_TASKS];
+    uint32_t total_run_time = 0;
+    UBaseType_t n;
+
+    memset(out, 0, sizeof(*out));
+    // One consistent view: no task runs while the counters are copied
+    vTaskSuspendAll();
+    {
+        out->tick = xTaskGetTickCount();
+        n = uxTaskGetSystemState(status, SIM_MAX_TASKS, &total_run_time);
+        out->total_run_time = total_run_time;
+        for (UBaseType_t i = 0; i < n; ++i) {
+            struct stats_task *t = &out->tasks[i];
+            strncpy(t->name, status[i].pcTaskName, sizeof(t->name) - 1);
+            t->id = (uint32_t)status[i].xTaskNumber;
+            t->state = (uint32_t)status[i].eCurrentState;
+            t->priority = (uint32_t)status[i].uxCurrentPriority;
+            t->run_time = (uint32_t)status[i].ulRunTimeCounter;
+            t->stack_free = (uint32_t)(status[i].usStackHighWaterMark * sizeof(StackType_t));
+        }
+        out->num_tasks = (uint32_t)n;
+#if configSUPPORT_DYNAMIC_ALLOCATION
+        out->free_heap = (uint32_t)xPortGetFreeHeapSize();
+        out->min_free_heap = (uint32_t)xPortGetMinimumEverFreeHeapSize();
+#endif
+        lru_cache_get_stats(&out->cache_hits, &out->cache_misses);
+        out->uart_tx_bytes = g_uart.tx_bytes;
+        out->uart_rx_bytes = g_uart.rx_bytes;
+        out->spi_tx_bytes = g_spi.tx_bytes;
+        out->spi_rx_bytes = g_spi.rx_bytes;
+        for (int i = 0; i < STATS_PCIE_INT_TYPES; ++i) {
+            out->pcie_irqs[i] = g_pci.int_count[PCI_INT_LEGACY + i];
+        }
+        out->latency_count = latency_count;
+        out->latency_sum = latency_sum;
+        out->latency_max = latency_max;
+        n = queue_stats_snapshot(out->queues, QUEUE_STATS_MAX);
+        out->num_queues = (uint32_t)(n < QUEUE_STATS_MAX ? n : QUEUE_STATS_MAX);
+    }
+    (void)xTaskResumeAll();
+}
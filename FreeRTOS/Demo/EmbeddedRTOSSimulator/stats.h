@@ -0,0 +1,47 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "task_scheduler.h"
+#include "queue_stats.h"
+
+#define STATS_PCIE_INT_TYPES 4   // LEGACY, MSI, MSIX, INTC (pci_int_type_t 1..4)
+
+struct stats_task {
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t id;            // Kernel task number, unique per task
+    uint32_t state;         // eTaskState
+    uint32_t priority;
+    uint32_t run_time;      // Cumulative run-time counter
+    uint32_t stack_free;    // Bytes, minimum ever
+};
+
+// One snapshot of every live counter in the simulator. Counters are
+// cumulative; consumers compute rates from consecutive snapshots.
+struct sim_stats {
+    uint32_t tick;
+    uint32_t total_run_time;
+    uint32_t free_heap;         // 0 in the static allocation build
+    uint32_t min_free_heap;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    uint32_t uart_tx_bytes;
+    uint32_t uart_rx_bytes;
+    uint32_t spi_tx_bytes;
+    uint32_t spi_rx_bytes;
+    uint32_t pcie_irqs[STATS_PCIE_INT_TYPES];
+    uint32_t latency_count;     // Sensor -> protocol task deliveries
+    uint32_t latency_sum;       // Ticks
+    uint32_t latency_max;       // Ticks
+    uint32_t num_tasks;
+    struct stats_task tasks[SIM_MAX_TASKS];
+    uint32_t num_queues;
+    struct queue_stats_entry queues[QUEUE_STATS_MAX];
+};
+
+void stats_collect(struct sim_stats *out);
+// Sensor sample age when the protocol task picks it up
+void stats_record_latency(TickType_t ticks);
+
+#endif // STATS_H
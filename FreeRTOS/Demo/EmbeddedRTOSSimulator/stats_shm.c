@@ -0,0 +1,127 @@
+#include "stats_shm.h"
+#include "stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+static struct stats_shm *segment = NULL;
+static const char *segment_name = NULL;
+static uint32_t publish_interval_ms = STATS_SHM_DEFAULT_INTERVAL_MS;
+
+static void stats_shm_at_exit(void) {
+    static struct sim_stats st;
+    // Called from the idle point: final counters for readers that outlive us
+    stats_collect(&st);
+    stats_shm_publish(segment, &st);
+    if (segment_name) {
+        shm_unlink(segment_name);
+    }
+}
+
+void stats_shm_attach(struct stats_shm *shm, uint32_t interval_ms) {
+    segment = shm;
+    segment->size = sizeof(struct stats_shm);
+    segment->version = STATS_SHM_VERSION;
+    segment->pid = (int32_t)getpid();
+    // Readers check the magic last: the header is complete once it is set
+    __atomic_store_n(&segment->magic, STATS_SHM_MAGIC, __ATOMIC_RELEASE);
+    publish_interval_ms = interval_ms;
+    atexit(stats_shm_at_exit);
+}
+
+int stats_shm_enabled(void) {
+    return segment != NULL;
+}
+
+int stats_shm_init(const char *name, uint32_t interval_ms) {
+    void *map;
+    int fd = shm_open(name, O_CREAT | O_RDWR | O_TRUNC, 0644);
+    if (fd < 0) {
+        printf("[StatsShm] shm_open(%s) failed: %s\n", name, strerror(errno));
+        return -1;
+    }
+    if (ftruncate(fd, sizeof(struct stats_shm)) != 0) {
+        printf("[StatsShm] Cannot size %s: %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    map = mmap(NULL, sizeof(struct stats_shm), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        printf("[StatsShm] Cannot map %s: %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return -1;
+    }
+    segment_name = name;
+    stats_shm_attach(map, interval_ms);
+    printf("[StatsShm] Publishing live stats in /dev/shm%s every %u ms\n", name, (unsigned)interval_ms);
+    return 0;
+}
+
+void stats_shm_publish(struct stats_shm *shm, const struct sim_stats *st) {
+    struct stats_shm_data *d = &shm->data;
+    // Seqlock write: odd sequence, data, even sequence
+    __atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    d->update_count++;
+    d->tick = st->tick;
+    d->tick_rate_hz = configTICK_RATE_HZ;
+    d->total_run_time = st->total_run_time;
+    d->free_heap = st->free_heap;
+    d->min_free_heap = st->min_free_heap;
+    d->cache_hits = st->cache_hits;
+    d->cache_misses = st->cache_misses;
+    d->uart_tx_bytes = st->uart_tx_bytes;
+    d->uart_rx_bytes = st->uart_rx_bytes;
+    d->spi_tx_bytes = st->spi_tx_bytes;
+    d->spi_rx_bytes = st->spi_rx_bytes;
+    memcpy(d->pcie_irqs, st->pcie_irqs, sizeof(d->pcie_irqs));
+    d->latency_count = st->latency_count;
+    d->latency_sum = st->latency_sum;
+    d->latency_max = st->latency_max;
+    d->num_tasks = st->num_tasks < STATS_SHM_MAX_TASKS ? st->num_tasks : STATS_SHM_MAX_TASKS;
+    for (uint32_t i = 0; i < d->num_tasks; ++i) {
+        struct stats_shm_task *t = &d->tasks[i];
+        snprintf(t->name, sizeof(t->name), "%s", st->tasks[i].name);
+        t->id = st->tasks[i].id;
+        t->state = st->tasks[i].state;
+        t->priority = st->tasks[i].priority;
+        t->run_time = st->tasks[i].run_time;
+        t->stack_free = st->tasks[i].stack_free;
+    }
+    d->num_queues = st->num_queues < STATS_SHM_MAX_QUEUES ? st->num_queues : STATS_SHM_MAX_QUEUES;
+    for (uint32_t i = 0; i < d->num_queues; ++i) {
+        const struct queue_stats_entry *q = &st->queues[i];
+        struct stats_shm_queue *sq = &d->queues[i];
+        snprintf(sq->name, sizeof(sq->name), "%s", q->name);
+        sq->length = q->length;
+        sq->waiting = q->waiting;
+        sq->peak = q->peak;
+        sq->sends = q->sends;
+        sq->receives = q->receives;
+        sq->send_failures = q->send_failures;
+        sq->receive_failures = q->receive_failures;
+        sq->send_blocked_ticks = q->send_blocked_ticks;
+        sq->receive_blocked_ticks = q->receive_blocked_ticks;
+    }
+    __atomic_store_n(&shm->seq, shm->seq + 1, __ATOMIC_RELEASE);
+}
+
+// --- Stats Shm Task: publishes a snapshot every interval ---
+void vStatsShmTask(void *pvParameters) {
+    static struct sim_stats st;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(publish_interval_ms);
+
+    if (period == 0) period = 1;
+    for (;;) {
+        stats_collect(&st);
+        stats_shm_publish(segment, &st);
+        vTaskDelayUntil(&last_wake, period);
+    }
+}
@@ -0,0 +1,100 @@
+#ifndef STATS_SHM_H
+#define STATS_SHM_H
+
+#include <stdint.h>
+
+// Live stats segment in POSIX shared memory (--shm). The layout uses only
+// fixed-width types, so external readers include this header and nothing
+// from FreeRTOS. One writer (the simulator) publishes under a seqlock:
+// seq is odd while an update is in progress, and a reader's copy is
+// consistent if seq was even and unchanged across the copy
+// (stats_shm_read()). Readers never block the simulator.
+#define STATS_SHM_MAGIC        0x53494D53u  // "SIMS"
+#define STATS_SHM_VERSION      1
+#define STATS_SHM_DEFAULT_NAME "/embedded_rtos_sim"
+#define STATS_SHM_DEFAULT_INTERVAL_MS 100
+#define STATS_SHM_MAX_TASKS    16
+#define STATS_SHM_MAX_QUEUES   8
+#define STATS_SHM_NAME_LEN     24
+#define STATS_SHM_PCIE_INT_TYPES 4          // LEGACY, MSI, MSIX, INTC
+
+struct stats_shm_task {
+    char name[STATS_SHM_NAME_LEN];
+    uint32_t id;
+    uint32_t state;             // eTaskState
+    uint32_t priority;
+    uint32_t run_time;          // Cumulative run-time counter
+    uint32_t stack_free;        // Bytes, minimum ever
+};
+
+struct stats_shm_queue {
+    char name[STATS_SHM_NAME_LEN];
+    uint32_t length;
+    uint32_t waiting;
+    uint32_t peak;
+    uint32_t sends;
+    uint32_t receives;
+    uint32_t send_failures;
+    uint32_t receive_failures;
+    uint64_t send_blocked_ticks;
+    uint64_t receive_blocked_ticks;
+};
+
+struct stats_shm_data {
+    uint64_t update_count;
+    uint32_t tick;
+    uint32_t tick_rate_hz;
+    uint32_t total_run_time;
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint32_t cache_hits;
+    uint32_t cache_misses;
+    uint32_t uart_tx_bytes;
+    uint32_t uart_rx_bytes;
+    uint32_t spi_tx_bytes;
+    uint32_t spi_rx_bytes;
+    uint32_t pcie_irqs[STATS_SHM_PCIE_INT_TYPES];
+    uint32_t latency_count;
+    uint32_t latency_sum;
+    uint32_t latency_max;
+    uint32_t num_tasks;
+    uint32_t num_queues;
+    struct stats_shm_task tasks[STATS_SHM_MAX_TASKS];
+    struct stats_shm_queue queues[STATS_SHM_MAX_QUEUES];
+};
+
+struct stats_shm {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;              // sizeof(struct stats_shm) of the writer
+    int32_t pid;                // Writer process
+    uint32_t seq;               // Seqlock sequence, odd while writing
+    uint32_t reserved;
+    struct stats_shm_data data;
+};
+
+// Reader side: copies a consistent snapshot. Returns 0, or -1 if the writer
+// kept updating for too many attempts (try again later).
+static inline int stats_shm_read(const struct stats_shm *shm, struct stats_shm_data *out) {
+    for (int attempt = 0; attempt < 1000; ++attempt) {
+        uint32_t begin = __atomic_load_n(&shm->seq, __ATOMIC_ACQUIRE);
+        if (begin & 1) continue;
+        __builtin_memcpy(out, (const void *)&shm->data, sizeof(*out));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&shm->seq, __ATOMIC_RELAXED) == begin) return 0;
+    }
+    return -1;
+}
+
+// Simulator side. stats_shm_init() creates and maps the named segment
+// (removed again at exit); stats_shm_attach() publishes into memory someone
+// else mapped (a fleet slot, see fleet.h). vStatsShmTask then publishes every
+// interval, and a last snapshot is published at exit.
+struct sim_stats;
+int stats_shm_init(const char *name, uint32_t interval_ms);
+void stats_shm_attach(struct stats_shm *shm, uint32_t interval_ms);
+int stats_shm_enabled(void);
+void stats_shm_publish(struct stats_shm *shm, const struct sim_stats *st);
+void vStatsShmTask(void *pvParameters);
+
+#endif // STATS_SHM_H
@@ -1,27 +1,56 @@
 #include "task_scheduler.h"
+#include "sim_alloc.h"
+#include "queue_stats.h"
+#include "sim_log.h"
 #include <stdio.h>
 
-// Inter-task communication handles
-typedef struct {
-    int sensor_value;
-    uint32_t timestamp;
-} sensor_msg_t;
-
-typedef struct {
-    char log[64];
-} protocol_log_t;
-
 QueueHandle_t qSensorToProtocol = NULL;
 QueueHandle_t qProtocolToLogger = NULL;
 SemaphoreHandle_t semPCIeEvent = NULL;
 EventGroupHandle_t egSystemEvents = NULL;
 
+static struct task_info task_registry[SIM_MAX_TASKS];
+static size_t num_tasks = 0;
+
 void task_scheduler_init(void) {
-    qSensorToProtocol = xQueueCreate(8, sizeof(sensor_msg_t));
-    qProtocolToLogger = xQueueCreate(8, sizeof(protocol_log_t));
-    semPCIeEvent = xSemaphoreCreateBinary();
-    egSystemEvents = xEventGroupCreate();
-    printf("[TaskScheduler] Queues, semaphore, and event group initialized.\n");
+    qSensorToProtocol = SIM_QUEUE_CREATE(QUEUE_LEN_SENSOR, sizeof(sensor_msg_t));
+    qProtocolToLogger = SIM_QUEUE_CREATE(QUEUE_LEN_LOG, sizeof(protocol_log_t));
+    semPCIeEvent = SIM_SEMAPHORE_CREATE_BINARY();
+    egSystemEvents = SIM_EVENT_GROUP_CREATE();
+    queue_stats_register(qSensorToProtocol, "qSensorToProtocol", QUEUE_LEN_SENSOR, sizeof(sensor_msg_t));
+    queue_stats_register(qProtocolToLogger, "qProtocolToLogger", QUEUE_LEN_LOG, sizeof(protocol_log_t));
+    // Semaphores are queues of empty items: tracked for the blocking they cause
+    queue_stats_register(semPCIeEvent, "semPCIeEvent", 1, 0);
+    SIM_LOG("[TaskScheduler] Queues, semaphore, and event group initialized.\n");
+}
+
+void task_scheduler_register_task(TaskHandle_t handle, const char *name, uint32_t stack_depth, UBaseType_t priority) {
+    if (handle == NULL) {
+        SIM_LOG("[TaskScheduler] Task %s could not be created!\n", name);
+        return;
+    }
+    if (num_tasks >= SIM_MAX_TASKS) {
+        SIM_LOG("[TaskScheduler] Task registry full, %s not tracked\n", name);
+        return;
+    }
+    task_registry[num_tasks].handle = handle;
+    task_registry[num_tasks].name = name;
+    task_registry[num_tasks].stack_depth = stack_depth;
+    task_registry[num_tasks].priority = priority;
+    // 1-based task number: lets trace hooks keep per-task state without a search
+    vTaskSetTaskNumber(handle, (UBaseType_t)(++num_tasks));
+}
+
+size_t task_scheduler_get_tasks(const struct task_info **tasks) {
+    *tasks = task_registry;
+    return num_tasks;
+}
+
+const struct task_info *task_scheduler_find_task(TaskHandle_t handle) {
+    for (size_t i = 0; i < num_tasks; ++i) {
+        if (task_registry[i].handle == handle) return &task_registry[i];
+    }
+    return NULL;
 }
 
 BaseType_t send_sensor_data(const void *data, TickType_t timeout) {
@@ -43,10 +72,30 @@ BaseType_t recv_protocol_log(void *data, TickType_t timeout) {
 void signal_pcie_event(void) {
     xSemaphoreGive(semPCIeEvent);
     xEventGroupSetBits(egSystemEvents, EV_SYSTEM_PCIE_INT);
-    printf("[TaskScheduler] PCIe event signaled.\n");
+    SIM_LOG("[TaskScheduler] PCIe event signaled.\n");
 }
 
 void wait_for_pcie_event(void) {
     xSemaphoreTake(semPCIeEvent, portMAX_DELAY);
-    printf("[TaskScheduler] PCIe event received.\n");
-}
\ No newline at end of file
+    SIM_LOG("[TaskScheduler] PCIe event received.\n");
+}
+#if configSUPPORT_STATIC_ALLOCATION
+// Kernel-owned tasks also need reserved memory when the heap is not linked
+void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer, StackType_t **ppxIdleTaskStackBuffer, uint32_t *pulIdleTaskStackSize) {
+    static StaticTask_t idle_tcb;
+    static StackType_t idle_stack[configMINIMAL_STACK_SIZE];
+    *ppxIdleTaskTCBBuffer = &idle_tcb;
+    *ppxIdleTaskStackBuffer = idle_stack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+#if configUSE_TIMERS
+void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer, StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize) {
+    static StaticTask_t timer_tcb;
+    static StackType_t timer_stack[configTIMER_TASK_STACK_DEPTH];
+    *ppxTimerTaskTCBBuffer = &timer_tcb;
+    *ppxTimerTaskStackBuffer = timer_stack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
+#endif
+#endif
@@ -2,6 +2,7 @@
 #define TASK_SCHEDULER_H
 
 #include "FreeRTOS.h"
+#include "task.h"
 #include "queue.h"
 #include "semphr.h"
 #include "event_groups.h"
@@ -11,6 +12,70 @@
 #define TASK_PRIO_PROTOCOL 3
 #define TASK_PRIO_LOGGER   2
 #define TASK_PRIO_PCIE     5
+#define TASK_PRIO_REPLAY   6  // Trace stimuli stand in for hardware interrupts
+#define TASK_PRIO_TELEMETRY 1 // Sampling only, never delays application work
+#define TASK_PRIO_SIM_TIME 6  // Run limit / exit request: must preempt a busy task set
+
+// Periodic task timing (ms): vTaskDelayUntil releases, deadline from the release
+#define TASK_PERIOD_SENSOR_MS     1000
+#define TASK_DEADLINE_SENSOR_MS   100   // Sample and hand over, or the protocol side is behind
+#define TASK_PERIOD_LOGGER_MS     2000
+#define TASK_DEADLINE_LOGGER_MS   2000
+#define TASK_PERIOD_PCIE_MS       5000
+#define TASK_DEADLINE_PCIE_MS     1000
+// Protocol is sporadic: one job per sensor sample, done before the next one
+#define TASK_DEADLINE_PROTOCOL_MS TASK_PERIOD_SENSOR_MS
+
+// Task stack depths (words)
+#define TASK_STACK_PCIE     512
+#define TASK_STACK_SENSOR   256
+#define TASK_STACK_PROTOCOL 256
+#define TASK_STACK_LOGGER   256
+#define TASK_STACK_REPLAY   512
+#define TASK_STACK_TELEMETRY 256  // Sample and datagram buffers are static
+#define TASK_STACK_STATS_SHM 256  // struct sim_stats is static in the task
+#define TASK_STACK_METRICS_LOG 256  // Sample and block buffer are static
+#define TASK_STACK_SIM_TIME 256   // exit() and the atexit() reports run here; their tables are static
+
+// Heap budget for the dynamic builds: every task main.c can create at once
+// (--replay, telemetry, --shm or fleet, --metrics-log all on) plus the idle
+// task. main.c checks it against configTOTAL_HEAP_SIZE at compile time, so a
+// new task must be added here. The per-task and object allowances also cover
+// the heap_pool class pools, which serve TCBs and queues.
+#define SIM_HEAP_TASK_STACKS (2 * TASK_STACK_PCIE + TASK_STACK_SENSOR + TASK_STACK_PROTOCOL + \
+                              TASK_STACK_LOGGER + TASK_STACK_SIM_TIME + TASK_STACK_REPLAY + \
+                              TASK_STACK_TELEMETRY + TASK_STACK_STATS_SHM + TASK_STACK_METRICS_LOG + \
+                              configMINIMAL_STACK_SIZE)
+#define SIM_HEAP_TASKS       11
+#define SIM_HEAP_PER_TASK    256   // TCB and allocator headers (bytes)
+#define SIM_HEAP_OBJECTS     4096  // Queues with their storage, semaphore, event group (bytes)
+#define SIM_HEAP_BUDGET      (SIM_HEAP_TASK_STACKS * sizeof(StackType_t) + \
+                              SIM_HEAP_TASKS * SIM_HEAP_PER_TASK + SIM_HEAP_OBJECTS)
+
+// Upper bound on tasks (application + idle/timer) for status snapshots
+#define SIM_MAX_TASKS       16
+
+// Inter-task queue depths
+#define QUEUE_LEN_SENSOR    8
+#define QUEUE_LEN_LOG       8
+
+// Inter-task message types
+typedef struct {
+    int sensor_value;
+    uint32_t timestamp;
+} sensor_msg_t;
+
+// Binary record: text formatting happens only in the logger
+typedef struct {
+    sensor_msg_t msg;       // Last sample in the frame
+    uint16_t seq;           // Link frame sequence number
+    uint8_t frame_len;      // Bytes on each link for this frame
+    uint8_t samples;        // Sensor samples carried by the frame
+    uint8_t loopback_ok;    // SPI loopback and PCIe copies decoded back to the frame sent
+    uint32_t peer_frames;   // Good frames received from the UART and SPI peers so far
+    uint32_t crc_errors;    // Frames rejected on UART, SPI and PCIe so far
+    uint32_t link_errors;   // Short writes on UART, SPI and PCIe so far
+} protocol_log_t;
 
 // Inter-task communication handles
 extern QueueHandle_t qSensorToProtocol;
@@ -25,6 +90,18 @@ extern EventGroupHandle_t egSystemEvents;
 
 void task_scheduler_init(void);
 
+// Task registry: tasks created through SIM_TASK_CREATE with their declared stack
+struct task_info {
+    TaskHandle_t handle;
+    const char *name;
+    uint32_t stack_depth;   // Words
+    UBaseType_t priority;
+};
+
+void task_scheduler_register_task(TaskHandle_t handle, const char *name, uint32_t stack_depth, UBaseType_t priority);
+size_t task_scheduler_get_tasks(const struct task_info **tasks);
+const struct task_info *task_scheduler_find_task(TaskHandle_t handle);
+
 // API for sending/receiving messages between tasks
 BaseType_t send_sensor_data(const void *data, TickType_t timeout);
 BaseType_t recv_sensor_data(void *data, TickType_t timeout);
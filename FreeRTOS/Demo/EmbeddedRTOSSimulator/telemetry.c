@@ -0,0 +1,210 @@
+#include "telemetry.h"
+#include "stats.h"
+#include "sim_log.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+static int sock = -1;
+static struct sockaddr_storage dest;
+static socklen_t dest_len;
+static uint16_t source_id;
+static uint32_t interval_ms = TELEMETRY_DEFAULT_INTERVAL_MS;
+static uint32_t batch = TELEMETRY_DEFAULT_BATCH;
+static uint32_t seq = 0;
+static uint32_t send_errors = 0;
+
+static uint8_t datagram[TELEMETRY_MAX_DATAGRAM];
+static size_t datagram_len = 0;
+static uint16_t datagram_count = 0;
+
+// --- Big-endian writers ---
+
+static uint8_t *put_u8(uint8_t *p, uint32_t v) {
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint8_t *put_u16(uint8_t *p, uint32_t v) {
+    *p++ = (uint8_t)(v >> 8);
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static uint8_t *put_u32(uint8_t *p, uint32_t v) {
+    *p++ = (uint8_t)(v >> 24);
+    *p++ = (uint8_t)(v >> 16);
+    *p++ = (uint8_t)(v >> 8);
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+int telemetry_init(const char *host, uint16_t port, uint16_t id, uint32_t interval, uint32_t samples_per_datagram) {
+    struct addrinfo hints, *res;
+    char port_str[8];
+    int err;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    snprintf(port_str, sizeof(port_str), "%u", (unsigned)port);
+    err = getaddrinfo(host, port_str, &hints, &res);
+    if (err != 0) {
+        printf("[Telemetry] Cannot resolve %s: %s\n", host, gai_strerror(err));
+        return -1;
+    }
+    sock = socket(res->ai_family, res->ai_socktype, res->ai_protocol);
+    if (sock < 0) {
+        printf("[Telemetry] socket() failed: %s\n", strerror(errno));
+        freeaddrinfo(res);
+        return -1;
+    }
+    memcpy(&dest, res->ai_addr, res->ai_addrlen);
+    dest_len = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    source_id = id;
+    interval_ms = interval;
+    batch = samples_per_datagram;
+    printf("[Telemetry] Sending to %s:%u as source %u, sample every %u ms, %u per datagram\n",
+           host, (unsigned)port, (unsigned)source_id, (unsigned)interval_ms, (unsigned)batch);
+    return 0;
+}
+
+static void datagram_begin(uint8_t type) {
+    uint8_t *p = datagram;
+    p = put_u32(p, TELEMETRY_MAGIC);
+    p = put_u8(p, TELEMETRY_VERSION);
+    p = put_u8(p, type);
+    p = put_u16(p, source_id);
+    p = put_u32(p, seq);
+    // count and reserved are filled in by datagram_send()
+    datagram_len = TELEMETRY_HEADER_SIZE;
+    datagram_count = 0;
+}
+
+static void datagram_send(void) {
+    put_u16(datagram + 12, datagram_count);
+    put_u16(datagram + 14, 0);
+    if (sendto(sock, datagram, datagram_len, 0, (struct sockaddr *)&dest, dest_len) < 0) {
+        // Report the first failure only; the receiver sees the gap in seq
+        if (send_errors++ == 0) {
+            printf("[Telemetry] sendto() failed: %s\n", strerror(errno));
+        }
+    }
+    seq++;
+    datagram_len = 0;
+    datagram_count = 0;
+}
+
+static void send_names(const struct sim_stats *st) {
+    datagram_begin(TELEMETRY_TYPE_NAMES);
+    for (uint32_t i = 0; i < st->num_tasks + st->num_queues; ++i) {
+        int is_queue = i >= st->num_tasks;
+        const char *name = is_queue ? st->queues[i - st->num_tasks].name : st->tasks[i].name;
+        uint32_t id = is_queue ? i - st->num_tasks + 1 : st->tasks[i].id;
+        size_t len = strlen(name);
+        uint8_t *p;
+        if (len > 255) len = 255;
+        if (datagram_len + 3 + len > sizeof(datagram)) {
+            datagram_send();
+            datagram_begin(TELEMETRY_TYPE_NAMES);
+        }
+        p = datagram + datagram_len;
+        p = put_u8(p, is_queue);
+        p = put_u8(p, id);
+        p = put_u8(p, (uint32_t)len);
+        memcpy(p, name, len);
+        datagram_len += 3 + len;
+        datagram_count++;
+    }
+    datagram_send();
+}
+
+static size_t sample_size(const struct sim_stats *st) {
+    return 4 + 17 * 4 + st->num_tasks * 12 + st->num_queues * 32;
+}
+
+static void append_sample(const struct sim_stats *st) {
+    uint8_t *p = datagram + datagram_len;
+    size_t len = sample_size(st);
+
+    p = put_u16(p, (uint32_t)len);
+    p = put_u8(p, st->num_tasks);
+    p = put_u8(p, st->num_queues);
+    p = put_u32(p, st->tick);
+    p = put_u32(p, st->total_run_time);
+    p = put_u32(p, st->free_heap);
+    p = put_u32(p, st->min_free_heap);
+    p = put_u32(p, st->cache_hits);
+    p = put_u32(p, st->cache_misses);
+    p = put_u32(p, st->uart_tx_bytes);
+    p = put_u32(p, st->uart_rx_bytes);
+    p = put_u32(p, st->spi_tx_bytes);
+    p = put_u32(p, st->spi_rx_bytes);
+    for (int i = 0; i < STATS_PCIE_INT_TYPES; ++i) {
+        p = put_u32(p, st->pcie_irqs[i]);
+    }
+    p = put_u32(p, st->latency_count);
+    p = put_u32(p, st->latency_sum);
+    p = put_u32(p, st->latency_max);
+    for (uint32_t i = 0; i < st->num_tasks; ++i) {
+        const struct stats_task *t = &st->tasks[i];
+        p = put_u8(p, t->id);
+        p = put_u8(p, t->state);
+        p = put_u8(p, t->priority);
+        p = put_u8(p, 0);
+        p = put_u32(p, t->run_time);
+        p = put_u32(p, t->stack_free);
+    }
+    for (uint32_t i = 0; i < st->num_queues; ++i) {
+        const struct queue_stats_entry *q = &st->queues[i];
+        p = put_u8(p, i + 1);
+        p = put_u8(p, 0);
+        p = put_u16(p, q->waiting);
+        p = put_u16(p, q->peak);
+        p = put_u16(p, q->length);
+        p = put_u32(p, q->sends);
+        p = put_u32(p, q->receives);
+        p = put_u32(p, q->send_failures);
+        p = put_u32(p, q->receive_failures);
+        p = put_u32(p, (uint32_t)q->send_blocked_ticks);
+        p = put_u32(p, (uint32_t)q->receive_blocked_ticks);
+    }
+    datagram_len += len;
+    datagram_count++;
+}
+
+// --- Telemetry Task: samples all counters and ships them in batches ---
+void vTelemetryTask(void *pvParameters) {
+    static struct sim_stats st;
+    TickType_t last_wake = xTaskGetTickCount();
+    TickType_t period = pdMS_TO_TICKS(interval_ms);
+    uint32_t datagrams_since_names = TELEMETRY_NAMES_EVERY;
+
+    if (period == 0) period = 1;
+    for (;;) {
+        vTaskDelayUntil(&last_wake, period);
+        stats_collect(&st);
+        if (datagram_len > 0 && datagram_len + sample_size(&st) > sizeof(datagram)) {
+            datagram_send();
+            datagrams_since_names++;
+        }
+        if (datagram_len == 0) {
+            if (datagrams_since_names >= TELEMETRY_NAMES_EVERY) {
+                send_names(&st);
+                datagrams_since_names = 0;
+            }
+            datagram_begin(TELEMETRY_TYPE_SAMPLES);
+        }
+        append_sample(&st);
+        if (datagram_count >= batch) {
+            datagram_send();
+            datagrams_since_names++;
+        }
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stdint.h>
+
+// Binary UDP telemetry. vTelemetryTask samples stats_collect() every
+// interval and batches samples into datagrams of at most
+// TELEMETRY_MAX_DATAGRAM bytes. All fields are big-endian.
+//
+// Header (16 bytes):
+//   u32 magic 'SIMT'  u8 version  u8 type  u16 source_id
+//   u32 seq (per source, +1 per datagram)  u16 count  u16 reserved
+//
+// TELEMETRY_TYPE_SAMPLES: count samples, each
+//   u16 length (whole sample)  u8 num_tasks  u8 num_queues
+//   u32 tick, total_run_time, free_heap, min_free_heap,
+//       cache_hits, cache_misses, uart_tx, uart_rx, spi_tx, spi_rx,
+//       pcie_irqs[4] (legacy, msi, msix, intc),
+//       latency_count, latency_sum, latency_max
+//   num_tasks x  { u8 id, u8 state, u8 priority, u8 reserved, u32 run_time, u32 stack_free }
+//   num_queues x { u8 id, u8 reserved, u16 waiting, u16 peak, u16 length,
+//                  u32 sends, receives, send_failures, receive_failures,
+//                      send_blocked_ticks, receive_blocked_ticks }
+//
+// TELEMETRY_TYPE_NAMES: count entries { u8 kind (0 task, 1 queue), u8 id, u8 len, name }
+// Sent first and every TELEMETRY_NAMES_EVERY datagrams, so receivers that
+// join late can label the ids. Counters are cumulative and wrap at 2^32.
+#define TELEMETRY_MAGIC          0x53494D54u  // "SIMT"
+#define TELEMETRY_VERSION        1
+#define TELEMETRY_TYPE_SAMPLES   1
+#define TELEMETRY_TYPE_NAMES     2
+#define TELEMETRY_HEADER_SIZE    16
+#define TELEMETRY_MAX_DATAGRAM   1400         // Below a 1500-byte MTU after IP/UDP headers
+#define TELEMETRY_NAMES_EVERY    16
+
+#define TELEMETRY_DEFAULT_HOST        "127.0.0.1"
+#define TELEMETRY_DEFAULT_PORT        5005
+#define TELEMETRY_DEFAULT_INTERVAL_MS 250
+#define TELEMETRY_DEFAULT_BATCH       4
+
+// Resolves the destination and opens the socket; returns -1 (and prints why)
+// if telemetry cannot be sent. Call before creating vTelemetryTask.
+int telemetry_init(const char *host, uint16_t port, uint16_t source_id, uint32_t interval_ms, uint32_t batch);
+void vTelemetryTask(void *pvParameters);
+
+#endif // TELEMETRY_H
@@ -1,5 +1,8 @@
 #include "uart.h"
 #include "board.h"
+#include "sim_alloc.h"
+#include "queue_stats.h"
+#include "sim_log.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -8,60 +11,118 @@ struct uart_state g_uart;
 // Forward declaration for event callback
 static void uart_rx_event_cb(void *context);
 
+// Kernel objects and callbacks are per process: created on init and restore
+static void uart_attach(void) {
+    g_uart.rx_queue = SIM_QUEUE_CREATE(UART_RX_BUFFER_SIZE, sizeof(char));
+    queue_stats_register(g_uart.rx_queue, "uart_rx_queue", UART_RX_BUFFER_SIZE, sizeof(char));
+    board_register_event(uart_rx_event_cb, NULL);
+}
+
 void uart_init(void) {
     memset(&g_uart, 0, sizeof(g_uart));
-    g_uart.rx_queue = xQueueCreate(UART_RX_BUFFER_SIZE, sizeof(char));
-    board_register_event(uart_rx_event_cb, NULL);
-    printf("[UART] Initialized (ARMv8A emu, RX queue size %d).\n", UART_RX_BUFFER_SIZE);
+    uart_attach();
+    SIM_LOG("[UART] Initialized (ARMv8A emu, RX queue size %d).\n", UART_RX_BUFFER_SIZE);
 }
 
-void uart_send(const char *data) {
-    // Simulate writing to TX buffer and hardware register
-    size_t len = strlen(data);
-    for (size_t i = 0; i < len; ++i) {
+void uart_restore(const struct uart_state *saved) {
+    g_uart = *saved;
+    g_uart.tx_tail = g_uart.tx_head; // Bytes left in TX were already on the line
+    uart_attach();
+    // Unread RX bytes go back into the new queue, which mirrors the ring
+    for (size_t i = g_uart.rx_tail; i != g_uart.rx_head; i = (i + 1) % UART_RX_BUFFER_SIZE) {
+        xQueueSend(g_uart.rx_queue, &g_uart.rx_buffer[i], 0);
+    }
+}
+
+// Copies into the TX ring; returns the bytes accepted. The simulated line
+// is faster than any writer: the transmitter empties the ring once the write
+// is done, so only a single write larger than the ring comes up short.
+static size_t uart_tx(const uint8_t *data, size_t len) {
+    size_t i;
+    for (i = 0; i < len; ++i) {
         size_t next = (g_uart.tx_head + 1) % UART_TX_BUFFER_SIZE;
         if (next == g_uart.tx_tail) {
-            printf("[UART] TX buffer full, dropping data.\n");
+            SIM_LOG("[UART] TX buffer full, dropping data.\n");
             break;
         }
-        g_uart.tx_buffer[g_uart.tx_head] = data[i];
+        g_uart.tx_buffer[g_uart.tx_head] = (char)data[i];
         g_uart.tx_head = next;
+        g_uart.tx_bytes++;
     }
+    g_uart.tx_tail = g_uart.tx_head; // Shifted out
     board_reg_write(BOARD_REG_UART, 1); // Simulate TX ready
-    printf("[UART] Send: %s\n", data);
+    return i;
+}
+
+// The RX queue mirrors the RX ring: a byte taken from the queue frees its slot
+static int uart_rx_pop(char *ch) {
+    if (xQueueReceive(g_uart.rx_queue, ch, 0) != pdTRUE) return 0;
+    if (g_uart.rx_tail != g_uart.rx_head) {
+        g_uart.rx_tail = (g_uart.rx_tail + 1) % UART_RX_BUFFER_SIZE;
+    }
+    return 1;
+}
+
+void uart_send(const char *data) {
+    // Simulate writing to TX buffer and hardware register
+    uart_tx((const uint8_t *)data, strlen(data));
+    SIM_LOG("[UART] Send: %s\n", data);
+}
+
+size_t uart_write(const void *data, size_t len) {
+    size_t sent = uart_tx(data, len);
+    SIM_LOG("[UART] Write: %u of %u bytes\n", (unsigned)sent, (unsigned)len);
+    return sent;
 }
 
 void uart_receive(char *buffer, int maxlen) {
     // Read from RX queue (blocking)
     int i = 0;
     char ch;
-    while (i < maxlen - 1 && xQueueReceive(g_uart.rx_queue, &ch, 0) == pdTRUE) {
+    while (i < maxlen - 1 && uart_rx_pop(&ch)) {
         buffer[i++] = ch;
     }
     buffer[i] = '\0';
-    printf("[UART] Receive: %s\n", buffer);
+    SIM_LOG("[UART] Receive: %s\n", buffer);
 }
 
-void uart_simulate_rx_event(const char *data) {
+size_t uart_read(void *buffer, size_t maxlen) {
+    char *out = buffer;
+    size_t n = 0;
+    while (n < maxlen && uart_rx_pop(&out[n])) {
+        n++;
+    }
+    if (n) SIM_LOG("[UART] Read: %u bytes\n", (unsigned)n);
+    return n;
+}
+
+size_t uart_simulate_rx_bytes(const void *data, size_t len) {
     // Simulate incoming data (e.g., from hardware/board)
-    size_t len = strlen(data);
-    for (size_t i = 0; i < len; ++i) {
+    const char *p = data;
+    size_t i;
+    for (i = 0; i < len; ++i) {
         size_t next = (g_uart.rx_head + 1) % UART_RX_BUFFER_SIZE;
         if (next == g_uart.rx_tail) {
-            printf("[UART] RX buffer full, dropping data.\n");
+            SIM_LOG("[UART] RX buffer full, dropping data.\n");
             break;
         }
-        g_uart.rx_buffer[g_uart.rx_head] = data[i];
+        g_uart.rx_buffer[g_uart.rx_head] = p[i];
         g_uart.rx_head = next;
+        g_uart.rx_bytes++;
         // Also push to FreeRTOS queue for task notification
-        xQueueSend(g_uart.rx_queue, &data[i], 0);
+        xQueueSend(g_uart.rx_queue, &p[i], 0);
     }
     board_reg_write(BOARD_REG_UART, 2); // Simulate RX ready
-    printf("[UART] Simulated RX event: %s\n", data);
+    return i;
+}
+
+void uart_simulate_rx_event(const char *data) {
+    uart_simulate_rx_bytes(data, strlen(data));
+    SIM_LOG("[UART] Simulated RX event: %s\n", data);
 }
 
 static void uart_rx_event_cb(void *context) {
     // This would be called by board_simulate_event (ISR context)
-    printf("[UART] RX event callback triggered (ISR).\n");
+    SIM_LOG("[UART] RX event callback triggered (ISR).\n");
     // In real code, would notify a task or set a flag
 }
\ No newline at end of file
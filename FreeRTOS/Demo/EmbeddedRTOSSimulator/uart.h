@@ -16,15 +16,24 @@ struct uart_state {
     char rx_buffer[UART_RX_BUFFER_SIZE];
     size_t rx_head, rx_tail;
     QueueHandle_t rx_queue; // For task notification
+    uint32_t tx_bytes;      // Bytes accepted into the TX buffer
+    uint32_t rx_bytes;      // Bytes received into the RX buffer
 };
 
 extern struct uart_state g_uart;
 
 void uart_init(void);
+// Warm start: load buffers and counters without bring-up (checkpoint.c)
+void uart_restore(const struct uart_state *saved);
 void uart_send(const char *data);
 void uart_receive(char *buffer, int maxlen);
+// Binary-safe variants (link frames): bytes accepted / bytes read, never block
+size_t uart_write(const void *data, size_t len);
+size_t uart_read(void *buffer, size_t maxlen);
 
 // Simulate UART RX interrupt/event
 void uart_simulate_rx_event(const char *data);
+// Same for binary data (replay): all len bytes, NUL included; returns bytes accepted
+size_t uart_simulate_rx_bytes(const void *data, size_t len);
 
 #endif // UART_H
\ No newline at end of file
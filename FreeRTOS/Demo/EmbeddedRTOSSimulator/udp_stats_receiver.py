@@ -1,33 +1,178 @@
-import socket
+import argparse
 import csv
+import socket
+import struct
 import time
 
-UDP_IP = "0.0.0.0"  # Listen on all interfaces
-UDP_PORT = 5005      # Match REMOTE_STATS_PORT in main.c
-CSV_FILE = "udp_stats_log.csv"
+# Binary telemetry format: see telemetry.h
+MAGIC = 0x53494D54  # "SIMT"
+VERSION = 1
+TYPE_SAMPLES = 1
+TYPE_NAMES = 2
+
+HEADER = struct.Struct(">IBBHIHH")
+SAMPLE_HEAD = struct.Struct(">HBB")
+SAMPLE_FIXED = struct.Struct(">17I")
+TASK = struct.Struct(">BBBBII")
+QUEUE = struct.Struct(">BBHHH6I")
+
+U32 = 1 << 32
+MISSING_WINDOW = 4096  # Lost sequence numbers remembered for late arrivals
+
+
+class Source:
+    """Per-simulator state: sequence tracking, names and the previous sample."""
+
+    def __init__(self):
+        self.next_seq = None
+        self.received = 0
+        self.lost = 0
+        self.late = 0
+        self.duplicates = 0
+        self.missing = set()
+        self.task_names = {}
+        self.queue_names = {}
+        self.prev = None
+
+    def track(self, seq):
+        self.received += 1
+        if self.next_seq is None or seq == self.next_seq:
+            pass
+        elif (seq - self.next_seq) % U32 < U32 // 2:
+            gap = (seq - self.next_seq) % U32
+            self.lost += gap
+            print(f"  ! lost {gap} datagram(s) before seq {seq}")
+            for s in range(max(0, gap - MISSING_WINDOW), gap):
+                self.missing.add((self.next_seq + s) % U32)
+        else:
+            # Older than expected: a reordered datagram was counted as lost
+            # when its gap was seen, anything else is a duplicate
+            self.late += 1
+            if seq in self.missing:
+                self.missing.discard(seq)
+                self.lost -= 1
+            else:
+                self.duplicates += 1
+            return False
+        self.next_seq = (seq + 1) % U32
+        if len(self.missing) > MISSING_WINDOW:
+            self.missing = {s for s in self.missing if (self.next_seq - s) % U32 <= MISSING_WINDOW}
+        return True
+
 
-print(f"Listening for UDP stats on {UDP_IP}:{UDP_PORT} ...")
+def decode_sample(data, off):
+    length, num_tasks, num_queues = SAMPLE_HEAD.unpack_from(data, off)
+    f = SAMPLE_FIXED.unpack_from(data, off + SAMPLE_HEAD.size)
+    s = {
+        "tick": f[0], "total_run_time": f[1], "free_heap": f[2], "min_free_heap": f[3],
+        "cache_hits": f[4], "cache_misses": f[5],
+        "uart_tx": f[6], "uart_rx": f[7], "spi_tx": f[8], "spi_rx": f[9],
+        "pcie_irqs": f[10:14],
+        "latency_count": f[14], "latency_sum": f[15], "latency_max": f[16],
+        "tasks": [], "queues": [],
+    }
+    p = off + SAMPLE_HEAD.size + SAMPLE_FIXED.size
+    for _ in range(num_tasks):
+        tid, state, prio, _r, run_time, stack_free = TASK.unpack_from(data, p)
+        s["tasks"].append({"id": tid, "state": state, "priority": prio,
+                           "run_time": run_time, "stack_free": stack_free})
+        p += TASK.size
+    for _ in range(num_queues):
+        v = QUEUE.unpack_from(data, p)
+        s["queues"].append({"id": v[0], "waiting": v[2], "peak": v[3], "length": v[4],
+                            "sends": v[5], "receives": v[6], "send_failures": v[7],
+                            "receive_failures": v[8], "send_blocked": v[9], "receive_blocked": v[10]})
+        p += QUEUE.size
+    return s, off + length
 
-sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
-sock.bind((UDP_IP, UDP_PORT))
 
-# Open CSV file for appending
-with open(CSV_FILE, 'a', newline='') as csvfile:
-    writer = csv.writer(csvfile)
-    writer.writerow(["timestamp", "heap", "q1", "q2", "sem", "ev"])
-    while True:
-        data, addr = sock.recvfrom(1024)
-        line = data.decode().strip()
-        print(f"Received from {addr}: {line}")
-        # Parse line like: HEAP:12345 Q1:2 Q2:1 SEM:0 EV:0x00000001
+def delta(cur, prev):
+    return (cur - prev) % U32
+
+
+def report(src_id, src, s, writer):
+    prev = src.prev
+    hits, misses = s["cache_hits"], s["cache_misses"]
+    lat_avg = s["latency_sum"] / s["latency_count"] if s["latency_count"] else 0.0
+    cpu = []
+    if prev:
+        total = delta(s["total_run_time"], prev["total_run_time"])
+        prev_tasks = {t["id"]: t for t in prev["tasks"]}
+        hits = delta(s["cache_hits"], prev["cache_hits"])
+        misses = delta(s["cache_misses"], prev["cache_misses"])
+        for t in s["tasks"]:
+            pt = prev_tasks.get(t["id"])
+            if pt and total:
+                name = src.task_names.get(t["id"], f"task{t['id']}")
+                cpu.append(f"{name}={100.0 * delta(t['run_time'], pt['run_time']) / total:.1f}%")
+    hit_pct = 100.0 * hits / (hits + misses) if hits + misses else 0.0
+    queues = " ".join(f"{src.queue_names.get(q['id'], q['id'])}={q['waiting']}/{q['length']}"
+                      for q in s["queues"])
+    print(f"[{src_id}] tick={s['tick']} heap={s['free_heap']} cache={hit_pct:.0f}% "
+          f"lat={lat_avg:.1f}/{s['latency_max']} {queues} {' '.join(cpu)}")
+    writer.writerow([time.time(), src_id, s["tick"], s["free_heap"], s["min_free_heap"],
+                     s["cache_hits"], s["cache_misses"], s["uart_tx"], s["uart_rx"],
+                     s["spi_tx"], s["spi_rx"], sum(s["pcie_irqs"]), f"{lat_avg:.2f}",
+                     s["latency_max"], src.lost])
+    src.prev = s
+
+
+def handle(data, addr, sources, writer):
+    if len(data) < HEADER.size:
+        print(f"Short datagram from {addr}")
+        return
+    magic, version, dtype, src_id, seq, count, _ = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        print(f"Unknown datagram from {addr} (magic {magic:#x}, version {version})")
+        return
+    src = sources.setdefault(src_id, Source())
+    in_order = src.track(seq)
+    off = HEADER.size
+    if dtype == TYPE_NAMES:
+        for _ in range(count):
+            kind, nid, length = struct.unpack_from(">BBB", data, off)
+            name = data[off + 3:off + 3 + length].decode(errors="replace")
+            (src.queue_names if kind else src.task_names)[nid] = name
+            off += 3 + length
+    elif dtype == TYPE_SAMPLES:
+        for _ in range(count):
+            s, off = decode_sample(data, off)
+            # Late datagrams still decode, but rates are only computed in order
+            if in_order:
+                report(src_id, src, s, writer)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Receive EmbeddedRTOSSimulator binary telemetry")
+    ap.add_argument("--bind", default="0.0.0.0", help="address to listen on")
+    ap.add_argument("--port", type=int, default=5005, help="match --stats-port of the simulator")
+    ap.add_argument("--csv", default="udp_stats_log.csv", help="CSV file to append samples to")
+    args = ap.parse_args()
+
+    print(f"Listening for UDP stats on {args.bind}:{args.port} ...")
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind((args.bind, args.port))
+    sources = {}
+    with open(args.csv, "a", newline="") as csvfile:
+        writer = csv.writer(csvfile)
+        writer.writerow(["timestamp", "source", "tick", "free_heap", "min_free_heap", "cache_hits",
+                         "cache_misses", "uart_tx", "uart_rx", "spi_tx", "spi_rx", "pcie_irqs",
+                         "latency_avg", "latency_max", "lost_datagrams"])
         try:
-            parts = dict(part.split(":") for part in line.replace("EV:", "EV:").split() if ":" in part)
-            heap = int(parts.get("HEAP", 0))
-            q1 = int(parts.get("Q1", 0))
-            q2 = int(parts.get("Q2", 0))
-            sem = int(parts.get("SEM", 0))
-            ev = parts.get("EV", "0")
-            writer.writerow([int(time.time()), heap, q1, q2, sem, ev])
-            csvfile.flush()
-        except Exception as e:
-            print(f"Parse error: {e}")
\ No newline at end of file
+            while True:
+                data, addr = sock.recvfrom(65535)
+                try:
+                    handle(data, addr, sources, writer)
+                except struct.error as e:
+                    print(f"Truncated datagram from {addr}: {e}")
+                csvfile.flush()
+        except KeyboardInterrupt:
+            for src_id, src in sources.items():
+                total = src.received + src.lost
+                pct = 100.0 * src.lost / total if total else 0.0
+                print(f"Source {src_id}: {src.received} datagrams, {src.lost} lost ({pct:.2f}%), {src.late} late, "
+                      f"{src.duplicates} duplicate")
+
+
+if __name__ == "__main__":
+    main()